@@ -0,0 +1,114 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FIND_NEWLINE_X86 1
+#endif
+
+#include "find_newline.h"
+
+/* ------------------------------------------------------------------------- */
+const char *find_newline_scalar(const char *p, const char *end) {
+    for (; p < end; ++p) {
+        if ('\n' == *p) {
+            return p;
+        }
+    }
+    return NULL;
+}   /* find_newline_scalar() */
+
+/* ------------------------------------------------------------------------- */
+static int find_newline_always(void) {
+    return 1;
+}   /* find_newline_always() */
+
+#if defined(FIND_NEWLINE_X86)
+
+/* ------------------------------------------------------------------------- */
+__attribute__((target("sse2")))
+static const char *find_newline_sse2(const char *p, const char *end) {
+    const __m128i newlines = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) p);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newlines));
+        if (0 != mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_newline_scalar(p, end);
+}   /* find_newline_sse2() */
+
+/* ------------------------------------------------------------------------- */
+__attribute__((target("avx2")))
+static const char *find_newline_avx2(const char *p, const char *end) {
+    const __m256i newlines = _mm256_set1_epi8('\n');
+    for (; end - p >= 64; p += 64) {
+        __m256i lo = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) p), newlines);
+        __m256i hi = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (p + 32)), newlines);
+        if (!_mm256_testz_si256(_mm256_or_si256(lo, hi), _mm256_or_si256(lo, hi))) {
+            uint32_t mask = (uint32_t) _mm256_movemask_epi8(lo);
+            if (0 != mask) {
+                return p + __builtin_ctz(mask);
+            }
+            return p + 32 + __builtin_ctz((uint32_t) _mm256_movemask_epi8(hi));
+        }
+    }
+    for (; end - p >= 32; p += 32) {
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) p), newlines));
+        if (0 != mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return find_newline_sse2(p, end);
+}   /* find_newline_avx2() */
+
+/* ------------------------------------------------------------------------- */
+static int find_newline_has_sse2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}   /* find_newline_has_sse2() */
+
+/* ------------------------------------------------------------------------- */
+static int find_newline_has_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}   /* find_newline_has_avx2() */
+
+#define FIND_NEWLINE_SSE2   find_newline_sse2
+#define FIND_NEWLINE_AVX2   find_newline_avx2
+#else
+#define FIND_NEWLINE_SSE2   NULL
+#define FIND_NEWLINE_AVX2   NULL
+#define find_newline_has_sse2   find_newline_always
+#define find_newline_has_avx2   find_newline_always
+#endif
+
+const find_newline_kernel_t g_find_newline_kernels[] = {
+    { "scalar", find_newline_scalar, find_newline_always },
+    { "sse2",   FIND_NEWLINE_SSE2,   find_newline_has_sse2 },
+    { "avx2",   FIND_NEWLINE_AVX2,   find_newline_has_avx2 },
+    { NULL,     NULL,                NULL },
+};
+
+static find_newline_func_t g_find_newline = NULL;  /**< Chosen on first use. */
+
+/* ------------------------------------------------------------------------- */
+const char *find_newline(const char *p, const char *end) {
+    find_newline_func_t find = __atomic_load_n(&g_find_newline, __ATOMIC_RELAXED);
+    if (NULL == find) {
+        const find_newline_kernel_t *kernel = NULL;
+        find = find_newline_scalar;
+        for (kernel = g_find_newline_kernels; NULL != kernel->name; ++kernel) {
+            if ((NULL != kernel->find) && kernel->supported()) {
+                find = kernel->find;
+            }
+        }
+        __atomic_store_n(&g_find_newline, find, __ATOMIC_RELAXED);
+    }
+    return find(p, end);
+}   /* find_newline() */
@@ -0,0 +1,53 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#ifndef MALLMOCK_FIND_NEWLINE_H_
+#define MALLMOCK_FIND_NEWLINE_H_
+
+/*
+ * Newline search for the line splitters in read_file.c.
+ *
+ * find_newline() uses the widest kernel the CPU supports, chosen on the
+ * first call: AVX2 or SSE2 compare-and-movemask on x86, otherwise a plain
+ * byte loop. The kernels are also available directly, for testing and
+ * benchmarking; those that the build target lacks are NULL in
+ * g_find_newline_kernels.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @return a pointer to the first '\n' in [@p p, @p end), or `NULL` if there
+ * is none.
+ */
+typedef const char *(*find_newline_func_t)(const char *p, const char *end);
+
+typedef struct find_newline_kernel_s {
+    const char *name;
+    find_newline_func_t find;   /**< `NULL` if not built for this target. */
+    int (*supported)(void);     /**< @return non-zero if this CPU can run it. */
+} find_newline_kernel_t;
+
+/**
+ * The kernels, slowest first, ending with a `NULL` name.
+ */
+extern const find_newline_kernel_t g_find_newline_kernels[];
+
+/**
+ * @return a pointer to the first '\n' in [@p p, @p end), or `NULL` if there
+ * is none, using the fastest kernel this CPU supports.
+ */
+const char *find_newline(const char *p, const char *end);
+
+/**
+ * One byte at a time.
+ */
+const char *find_newline_scalar(const char *p, const char *end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MALLMOCK_FIND_NEWLINE_H_
@@ -0,0 +1,119 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Unit test program for find_newline.h/.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cut.h"
+#include "find_newline.h"
+
+const char *g_program_name = "find_newline_test"; /**< This program name; overwritten by argv[0]. */
+
+#define TEST_BUFFER_SIZE    300
+
+typedef struct test_s {
+    char buffer[TEST_BUFFER_SIZE];
+} test_t;
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_init(test_t *test) {
+    memset(test->buffer, 'x', sizeof(test->buffer));
+    srand(1);
+    CUT_TEST_PASS();
+}   /* test_init() */
+
+/* ------------------------------------------------------------------------- */
+static void test_exit(test_t *test) {
+}   /* test_exit() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Check @p find against find_newline_scalar() for every start and end in
+ * @p test->buffer.
+ */
+static cut_result_t check_kernel(const char *file, int line, test_t *test, find_newline_func_t find) {
+    const char *buf = test->buffer;
+    size_t start = 0;
+    size_t end = 0;
+
+    for (start = 0; start < 70; ++start) {
+        for (end = start; end <= TEST_BUFFER_SIZE; ++end) {
+            CUT_FL_ASSERT_POINTER(file, line, find_newline_scalar(&buf[start], &buf[end]),
+                                  find(&buf[start], &buf[end]));
+        }
+    }
+    return CUT_RESULT_PASS;
+}   /* check_kernel() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_find_newline_kernels(test_t *test) {
+    const find_newline_kernel_t *kernel = NULL;
+    int i = 0;
+
+    CUT_ASSERT_NULL(find_newline_scalar(test->buffer, test->buffer + TEST_BUFFER_SIZE));
+    test->buffer[100] = '\n';
+    CUT_ASSERT_POINTER(&test->buffer[100], find_newline_scalar(test->buffer, test->buffer + TEST_BUFFER_SIZE));
+    CUT_ASSERT_POINTER(&test->buffer[100], find_newline(test->buffer, test->buffer + TEST_BUFFER_SIZE));
+    CUT_ASSERT_NULL(find_newline(test->buffer, test->buffer + 100));
+    test->buffer[100] = 'x';
+
+    for (kernel = g_find_newline_kernels; NULL != kernel->name; ++kernel) {
+        if ((NULL == kernel->find) || !kernel->supported()) {
+            continue;
+        }
+        CUT_RETURN(check_kernel(__FILE__, __LINE__, test, kernel->find));
+        for (i = 0; i < 8; ++i) {
+            test->buffer[rand() % TEST_BUFFER_SIZE] = '\n';
+            CUT_RETURN(check_kernel(__FILE__, __LINE__, test, kernel->find));
+        }
+        memset(test->buffer, 'x', sizeof(test->buffer));
+    }
+    CUT_TEST_PASS();
+}   /* test_find_newline_kernels() */
+
+/* ------------------------------------------------------------------------- */
+void test_find_newline(void) {
+    CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
+    CUT_ADD_TEST(test_find_newline_kernels);
+}   /* test_find_newline() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) CUT_GNU_ATTRIBUTE((noexit));
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [test-substring...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "\n");
+    cut_usage(f);
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    int i = 0;
+    g_program_name = argv[0];
+
+    cut_parse_command_line(&argc, argv);
+
+    CUT_INSTALL_SUITE(test_find_newline);
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else {
+            if (!cut_include_test(argv[i])) {
+                fprintf(stderr, "%s: no test names match '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+
+    return cut_run(1);
+}   /* main() */
@@ -0,0 +1,306 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#ifndef MALLMOCK_HASH_TABLE_H_
+#define MALLMOCK_HASH_TABLE_H_
+
+/*
+ * Intrusive hash table. Embed a hash_link_t in your struct, supply a hash
+ * function on keys and an equality function between a link and a key, and
+ * use STRUCT_CONTAINING_LINK() to get back to your struct, as with list_t.
+ *
+ * Each bucket is a list_t. The bucket count is a power of two, doubled when
+ * the table holds as many links as buckets. Rather than rehashing
+ * everything at once, the old bucket array is kept and a few of its buckets
+ * are moved to the new one on each insert; lookups check both until the
+ * move is done. If a bigger bucket array can't be allocated the table just
+ * gets more crowded, and tries again on a later insert.
+ *
+ * The table never allocates or frees links. Removal is O(1) because a link
+ * knows its neighbours.
+ */
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "link_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Smallest number of buckets, allocated on the first insert.
+ */
+#define HASH_TABLE_MIN_BUCKETS      16
+
+/**
+ * Number of old buckets moved to the new bucket array on each insert while
+ * resizing. Anything over 1 finishes a resize before the next one is due.
+ */
+#define HASH_TABLE_MIGRATE_BUCKETS  2
+
+typedef struct hash_link_s {
+    link_t link;
+    size_t hash;    /**< Hash of this link's key; set by hash_table_insert(). */
+} hash_link_t;
+
+/**
+ * @return the hash of @p key. Only the low bits pick the bucket, so they
+ * should be well mixed.
+ */
+typedef size_t (*hash_table_hash_func_t)(const void* key);
+
+/**
+ * @return non-zero if @p link holds @p key.
+ */
+typedef int (*hash_table_equal_func_t)(const hash_link_t* link, const void* key);
+
+typedef struct hash_table_s {
+    list_t* buckets;            /**< Bucket array, or NULL before the first insert. */
+    size_t bucket_count;
+    list_t* old_buckets;        /**< Buckets being moved to @a buckets, or NULL. */
+    size_t old_bucket_count;
+    size_t migrate_index;       /**< Next bucket in @a old_buckets to move. */
+    size_t count;               /**< Number of links in the table. */
+    hash_table_hash_func_t hash;
+    hash_table_equal_func_t equal;
+} hash_table_t;
+
+/**
+ * Intended usage:
+ *
+ *    hash_table_t g_my_table = HASH_TABLE_INIT(my_hash, my_equal);
+ */
+#define HASH_TABLE_INIT(_hash,_equal) { NULL, 0, NULL, 0, 0, 0, (_hash), (_equal) }
+
+static inline hash_table_t* hash_table_init(hash_table_t* ht,
+                                            hash_table_hash_func_t hash,
+                                            hash_table_equal_func_t equal) {
+    ht->buckets = NULL;
+    ht->bucket_count = 0;
+    ht->old_buckets = NULL;
+    ht->old_bucket_count = 0;
+    ht->migrate_index = 0;
+    ht->count = 0;
+    ht->hash = hash;
+    ht->equal = equal;
+    return ht;
+}   /* hash_table_init() */
+
+/**
+ * Free the bucket arrays of @p ht, leaving it empty. Links still in the
+ * table are simply forgotten; they belong to the caller.
+ */
+static inline void hash_table_destroy(hash_table_t* ht) {
+    free(ht->buckets);
+    free(ht->old_buckets);
+    hash_table_init(ht, ht->hash, ht->equal);
+}   /* hash_table_destroy() */
+
+static inline size_t hash_table_count(const hash_table_t* ht) {
+    return ht->count;
+}   /* hash_table_count() */
+
+static inline int hash_table_empty(const hash_table_t* ht) {
+    return 0 == ht->count;
+}   /* hash_table_empty() */
+
+/**
+ * FNV-1a hash of @p size bytes at @p data, for use in hash functions.
+ */
+static inline size_t hash_table_hash_bytes(const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*) data;
+    uint64_t hash = 0xCBF29CE484222325ull;
+    while (size-- > 0) {
+        hash ^= *p++;
+        hash *= 0x100000001B3ull;
+    }
+    return (size_t) (hash ^ (hash >> 32));
+}   /* hash_table_hash_bytes() */
+
+/**
+ * Bucket arrays come from calloc(), so a bucket whose next pointer is NULL
+ * has never been used and is empty.
+ */
+static inline int hash_bucket_empty(list_t* bucket) {
+    return (NULL == bucket->next) || list_empty(bucket);
+}   /* hash_bucket_empty() */
+
+static inline void hash_bucket_insert(list_t* bucket, hash_link_t* link) {
+    if (NULL == bucket->next) {
+        list_init(bucket);
+    }
+    list_insert_prev(bucket, &link->link);
+}   /* hash_bucket_insert() */
+
+static inline hash_link_t* hash_bucket_find(hash_table_t* ht, list_t* bucket, size_t hash, const void* key) {
+    if (NULL != bucket->next) {
+        list_foreach_struct(bucket, link, hash_link_t, link,
+                            if ((link->hash == hash) && ht->equal(link, key)) {
+                                return link;
+                            });
+    }
+    return NULL;
+}   /* hash_bucket_find() */
+
+/**
+ * Move up to @p max_buckets old buckets into the new bucket array, freeing
+ * the old array once it is empty.
+ */
+static inline void hash_table_migrate(hash_table_t* ht, size_t max_buckets) {
+    while ((NULL != ht->old_buckets) && (max_buckets-- > 0)) {
+        list_t* old_bucket = &ht->old_buckets[ht->migrate_index];
+        if (NULL != old_bucket->next) {
+            list_foreach_struct(old_bucket, link, hash_link_t, link,
+                                link_remove(&link->link);
+                                hash_bucket_insert(&ht->buckets[link->hash & (ht->bucket_count - 1)], link));
+        }
+        if (++ht->migrate_index == ht->old_bucket_count) {
+            free(ht->old_buckets);
+            ht->old_buckets = NULL;
+            ht->old_bucket_count = 0;
+            ht->migrate_index = 0;
+        }
+    }
+}   /* hash_table_migrate() */
+
+/**
+ * Start moving to a bucket array twice the size, if one can be allocated.
+ * Any earlier resize is finished first.
+ */
+static inline void hash_table_grow(hash_table_t* ht) {
+    size_t new_count = (0 == ht->bucket_count) ? HASH_TABLE_MIN_BUCKETS : 2 * ht->bucket_count;
+    list_t* new_buckets = (list_t*) calloc(new_count, sizeof(list_t));
+    if (NULL == new_buckets) {
+        return;
+    }
+    hash_table_migrate(ht, ht->old_bucket_count);
+    ht->old_buckets = ht->buckets;
+    ht->old_bucket_count = ht->bucket_count;
+    ht->migrate_index = 0;
+    ht->buckets = new_buckets;
+    ht->bucket_count = new_count;
+}   /* hash_table_grow() */
+
+/**
+ * @return the link in @p ht holding @p key, or NULL if there is none.
+ */
+static inline hash_link_t* hash_table_find(hash_table_t* ht, const void* key) {
+    size_t hash = 0;
+    hash_link_t* link = NULL;
+    if (0 == ht->count) {
+        return NULL;
+    }
+    hash = ht->hash(key);
+    if (NULL != ht->old_buckets) {
+        size_t index = hash & (ht->old_bucket_count - 1);
+        if (index >= ht->migrate_index) {
+            link = hash_bucket_find(ht, &ht->old_buckets[index], hash, key);
+        }
+    }
+    if (NULL == link) {
+        link = hash_bucket_find(ht, &ht->buckets[hash & (ht->bucket_count - 1)], hash, key);
+    }
+    return link;
+}   /* hash_table_find() */
+
+/**
+ * Insert @p link with key @p key into @p ht. Duplicate keys are not checked
+ * for; use hash_table_find() first if they're not wanted.
+ *
+ * @return @p link, or NULL if the first bucket array can't be allocated.
+ */
+static inline hash_link_t* hash_table_insert(hash_table_t* ht, hash_link_t* link, const void* key) {
+    if (ht->count >= ht->bucket_count) {
+        hash_table_grow(ht);
+        if (NULL == ht->buckets) {
+            return NULL;
+        }
+    }
+    hash_table_migrate(ht, HASH_TABLE_MIGRATE_BUCKETS);
+    link->hash = ht->hash(key);
+    hash_bucket_insert(&ht->buckets[link->hash & (ht->bucket_count - 1)], link);
+    ht->count++;
+    return link;
+}   /* hash_table_insert() */
+
+/**
+ * Remove @p link, which must be in @p ht.
+ */
+static inline hash_link_t* hash_table_remove(hash_table_t* ht, hash_link_t* link) {
+    link_remove(&link->link);
+    ht->count--;
+    return link;
+}   /* hash_table_remove() */
+
+/**
+ * @return the link holding @p key after removing it from @p ht, or NULL if
+ * there is none.
+ */
+static inline hash_link_t* hash_table_remove_key(hash_table_t* ht, const void* key) {
+    hash_link_t* link = hash_table_find(ht, key);
+    return (NULL == link) ? NULL : hash_table_remove(ht, link);
+}   /* hash_table_remove_key() */
+
+/**
+ * @return the first link in the first non-empty bucket at or after
+ * @p position, counting the old buckets first, or NULL if there is none.
+ */
+static inline hash_link_t* hash_table_first_from(hash_table_t* ht, size_t position) {
+    for (; position < ht->old_bucket_count + ht->bucket_count; ++position) {
+        list_t* bucket = (position < ht->old_bucket_count) ?
+            &ht->old_buckets[position] : &ht->buckets[position - ht->old_bucket_count];
+        if (!hash_bucket_empty(bucket)) {
+            return STRUCT_CONTAINING_LINK(bucket->next, hash_link_t, link);
+        }
+    }
+    return NULL;
+}   /* hash_table_first_from() */
+
+/**
+ * @return the link after @p link in @p ht, in no particular order, or the
+ * first link if @p link is NULL. Returns NULL after the last link.
+ */
+static inline hash_link_t* hash_table_next(hash_table_t* ht, hash_link_t* link) {
+    uintptr_t next = 0;
+    if (NULL == link) {
+        return hash_table_first_from(ht, 0);
+    }
+    next = (uintptr_t) link->link.next;
+    if ((NULL != ht->old_buckets) &&
+        (next >= (uintptr_t) ht->old_buckets) &&
+        (next < (uintptr_t) (ht->old_buckets + ht->old_bucket_count))) {
+        return hash_table_first_from(ht, (list_t*) next - ht->old_buckets + 1);
+    }
+    if ((next >= (uintptr_t) ht->buckets) &&
+        (next < (uintptr_t) (ht->buckets + ht->bucket_count))) {
+        return hash_table_first_from(ht, ht->old_bucket_count + ((list_t*) next - ht->buckets) + 1);
+    }
+    return STRUCT_CONTAINING_LINK(link->link.next, hash_link_t, link);
+}   /* hash_table_next() */
+
+/**
+ * Using @a _htp as a hash table of structures of type @a _struct_type that
+ * are linked through hash_link_t field name @a _link_field_name, for each
+ * struct pointer @a _structp in the table, execute @a _code.
+ *
+ * @a _structp may be safely removed from @a _htp in @a _code, but nothing
+ * may be inserted.
+ */
+#define hash_table_foreach_struct(_htp,_structp,_struct_type,_link_field_name,_code) \
+    do {                                                                \
+        hash_link_t* __link = hash_table_next((_htp), NULL);            \
+        hash_link_t* __next = NULL;                                     \
+        for (; NULL != __link; __link = __next) {                       \
+            __next = hash_table_next((_htp), __link);                   \
+            _struct_type* _structp = STRUCT_CONTAINING_LINK(__link, _struct_type, _link_field_name); \
+            _code ;                                                     \
+        }                                                               \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MALLMOCK_HASH_TABLE_H_
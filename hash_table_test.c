@@ -0,0 +1,185 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Unit test program for hash_table.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cut.h"
+#include "hash_table.h"
+#include "mallmock.h"
+
+const char *g_program_name = "hash_table_test"; /**< This program name; overwritten by argv[0]. */
+
+#define TEST_ITEMS  5000
+
+typedef struct item_s {
+    int key;
+    hash_link_t link;
+} item_t;
+
+typedef struct test_s {
+    hash_table_t ht;
+    item_t items[TEST_ITEMS];
+} test_t;
+
+/* ------------------------------------------------------------------------- */
+static size_t hash_int(const void *key) {
+    return hash_table_hash_bytes(key, sizeof(int));
+}   /* hash_int() */
+
+/* ------------------------------------------------------------------------- */
+static int equal_int(const hash_link_t *link, const void *key) {
+    return STRUCT_CONTAINING_LINK(link, item_t, link)->key == *(const int *) key;
+}   /* equal_int() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_init(test_t *test) {
+    int i = 0;
+    hash_table_init(&test->ht, hash_int, equal_int);
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        test->items[i].key = 3 * i;
+    }
+    CUT_TEST_PASS();
+}   /* test_init() */
+
+/* ------------------------------------------------------------------------- */
+static void test_exit(test_t *test) {
+    mallmock_reset();
+    hash_table_destroy(&test->ht);
+}   /* test_exit() */
+
+/* ------------------------------------------------------------------------- */
+static hash_link_t *find(test_t *test, int key) {
+    return hash_table_find(&test->ht, &key);
+}   /* find() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_hash_table_basic(test_t *test) {
+    hash_table_t static_ht = HASH_TABLE_INIT(hash_int, equal_int);
+    int key = 3;
+
+    CUT_ASSERT(hash_table_empty(&static_ht));
+    CUT_ASSERT_NULL(hash_table_find(&static_ht, &key));
+    CUT_ASSERT_NULL(hash_table_next(&static_ht, NULL));
+
+    CUT_ASSERT_POINTER(&test->items[1].link, hash_table_insert(&test->ht, &test->items[1].link, &key));
+    CUT_ASSERT_INT(1, hash_table_count(&test->ht));
+    CUT_ASSERT_POINTER(&test->items[1].link, find(test, 3));
+    CUT_ASSERT_NULL(find(test, 4));
+    CUT_ASSERT_POINTER(&test->items[1].link, hash_table_remove_key(&test->ht, &key));
+    CUT_ASSERT_NULL(hash_table_remove_key(&test->ht, &key));
+    CUT_ASSERT(hash_table_empty(&test->ht));
+    CUT_TEST_PASS();
+}   /* test_hash_table_basic() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_hash_table_many(test_t *test) {
+    int resizing = 0;
+    int visited = 0;
+    int i = 0;
+
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        CUT_ASSERT_NOT_NULL(hash_table_insert(&test->ht, &test->items[i].link, &test->items[i].key));
+        if (NULL != test->ht.old_buckets) {
+            resizing++;
+            CUT_ASSERT_POINTER(&test->items[i / 2].link, find(test, test->items[i / 2].key));
+        }
+    }
+    CUT_ASSERT(resizing > 0);
+    CUT_ASSERT_INT(TEST_ITEMS, hash_table_count(&test->ht));
+    CUT_ASSERT(test->ht.bucket_count >= TEST_ITEMS / 2);
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        CUT_ASSERT_POINTER(&test->items[i].link, find(test, test->items[i].key));
+        CUT_ASSERT_NULL(find(test, test->items[i].key + 1));
+    }
+
+    /* Remove the odd keys while iterating. */
+    hash_table_foreach_struct(&test->ht, item, item_t, link,
+                              visited++;
+                              if (item->key & 1) { hash_table_remove(&test->ht, &item->link); });
+    CUT_ASSERT_INT(TEST_ITEMS, visited);
+    CUT_ASSERT_INT(TEST_ITEMS / 2, hash_table_count(&test->ht));
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        if (test->items[i].key & 1) {
+            CUT_ASSERT_NULL(find(test, test->items[i].key));
+        } else {
+            CUT_ASSERT_POINTER(&test->items[i].link, find(test, test->items[i].key));
+        }
+    }
+    CUT_TEST_PASS();
+}   /* test_hash_table_many() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_hash_table_low_memory(test_t *test) {
+    int i = 0;
+
+    /* The first insert needs buckets. */
+    mallmock_set_any_alloc_return(NULL, 0);
+    CUT_ASSERT_NULL(hash_table_insert(&test->ht, &test->items[0].link, &test->items[0].key));
+    CUT_ASSERT(hash_table_empty(&test->ht));
+
+    /* Without a bigger bucket array the table just gets crowded. */
+    mallmock_set_any_alloc_return(NULL, 1);
+    for (i = 0; i <= HASH_TABLE_MIN_BUCKETS; ++i) {
+        CUT_ASSERT_NOT_NULL(hash_table_insert(&test->ht, &test->items[i].link, &test->items[i].key));
+    }
+    CUT_ASSERT_INT(HASH_TABLE_MIN_BUCKETS, test->ht.bucket_count);
+    CUT_ASSERT_INT(HASH_TABLE_MIN_BUCKETS + 1, hash_table_count(&test->ht));
+    for (i = 0; i <= HASH_TABLE_MIN_BUCKETS; ++i) {
+        CUT_ASSERT_POINTER(&test->items[i].link, find(test, test->items[i].key));
+    }
+
+    /* The next insert tries again. */
+    CUT_ASSERT_NOT_NULL(hash_table_insert(&test->ht, &test->items[i].link, &test->items[i].key));
+    CUT_ASSERT_INT(2 * HASH_TABLE_MIN_BUCKETS, test->ht.bucket_count);
+    CUT_TEST_PASS();
+}   /* test_hash_table_low_memory() */
+
+/* ------------------------------------------------------------------------- */
+void test_hash_table(void) {
+    CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
+    CUT_ADD_TEST(test_hash_table_basic);
+    CUT_ADD_TEST(test_hash_table_many);
+    CUT_ADD_TEST(test_hash_table_low_memory);
+}   /* test_hash_table() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) CUT_GNU_ATTRIBUTE((noexit));
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [test-substring...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "\n");
+    cut_usage(f);
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    int i = 0;
+    g_program_name = argv[0];
+
+    cut_parse_command_line(&argc, argv);
+
+    CUT_INSTALL_SUITE(test_hash_table);
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else {
+            if (!cut_include_test(argv[i])) {
+                fprintf(stderr, "%s: no test names match '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+
+    return cut_run(1);
+}   /* main() */
@@ -0,0 +1,274 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#ifndef MALLMOCK_INDEX_LIST_H_
+#define MALLMOCK_INDEX_LIST_H_
+
+/*
+ * Indexed list: an ordered sequence of links that supports insertion and
+ * removal at any position, and lookup by position, in O(log n) expected
+ * time. Embed an index_link_t in your struct and use
+ * STRUCT_CONTAINING_LINK() to get back to it, as with list_t.
+ *
+ * Internally this is a treap ordered by position: a binary tree in which
+ * each link knows the size of its subtree, kept balanced by giving each
+ * link a random heap priority.
+ */
+#include <stdlib.h>     /* sadly, for NULL. */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "link_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct index_link_s index_link_t;
+
+struct index_link_s {
+    index_link_t* parent;
+    index_link_t* left;     /**< Links before this one. */
+    index_link_t* right;    /**< Links after this one. */
+    size_t size;            /**< Number of links in this subtree, this included. */
+    uint32_t priority;      /**< Random; parents have higher priority. */
+};
+
+typedef struct index_list_s {
+    index_link_t* root;
+    uint32_t seed;          /**< State of the priority generator. */
+} index_list_t;
+
+/**
+ * Intended usage:
+ *
+ *    index_list_t g_my_index_list = INDEX_LIST_INIT;
+ */
+#define INDEX_LIST_INIT { NULL, 0x9E3779B9u }
+
+static inline index_list_t* index_list_init(index_list_t* il) {
+    il->root = NULL;
+    il->seed = 0x9E3779B9u;
+    return il;
+}   /* index_list_init() */
+
+static inline size_t index_link_size(const index_link_t* link) {
+    return (NULL == link) ? 0 : link->size;
+}   /* index_link_size() */
+
+static inline size_t index_list_count(const index_list_t* il) {
+    return index_link_size(il->root);
+}   /* index_list_count() */
+
+static inline int index_list_empty(const index_list_t* il) {
+    return NULL == il->root;
+}   /* index_list_empty() */
+
+/**
+ * @return the (0-based) @p n-th link in @p il, or NULL if there is none.
+ */
+static inline index_link_t* index_list_nth(index_list_t* il, size_t n) {
+    index_link_t* link = il->root;
+    while (NULL != link) {
+        size_t left_size = index_link_size(link->left);
+        if (n < left_size) {
+            link = link->left;
+        } else if (n == left_size) {
+            return link;
+        } else {
+            n -= left_size + 1;
+            link = link->right;
+        }
+    }
+    return NULL;
+}   /* index_list_nth() */
+
+/**
+ * @return the (0-based) position of @p link, which must be in @p il.
+ */
+static inline size_t index_list_index_of(index_list_t* il, index_link_t* link) {
+    size_t index = index_link_size(link->left);
+    (void) il;
+    while (NULL != link->parent) {
+        if (link == link->parent->right) {
+            index += index_link_size(link->parent->left) + 1;
+        }
+        link = link->parent;
+    }
+    return index;
+}   /* index_list_index_of() */
+
+/**
+ * @return the first link in @p il, or NULL if it is empty.
+ */
+static inline index_link_t* index_list_first(index_list_t* il) {
+    index_link_t* link = il->root;
+    if (NULL != link) {
+        while (NULL != link->left) {
+            link = link->left;
+        }
+    }
+    return link;
+}   /* index_list_first() */
+
+/**
+ * @return the link after @p link, or NULL if it is the last.
+ */
+static inline index_link_t* index_link_next(index_link_t* link) {
+    if (NULL != link->right) {
+        link = link->right;
+        while (NULL != link->left) {
+            link = link->left;
+        }
+        return link;
+    }
+    while ((NULL != link->parent) && (link == link->parent->right)) {
+        link = link->parent;
+    }
+    return link->parent;
+}   /* index_link_next() */
+
+/**
+ * Rotate @p link above its parent, keeping the order of the list.
+ */
+static inline void index_list_rotate_up(index_list_t* il, index_link_t* link) {
+    index_link_t* parent = link->parent;
+    index_link_t* grandparent = parent->parent;
+    if (link == parent->left) {
+        parent->left = link->right;
+        if (NULL != link->right) {
+            link->right->parent = parent;
+        }
+        link->right = parent;
+    } else {
+        parent->right = link->left;
+        if (NULL != link->left) {
+            link->left->parent = parent;
+        }
+        link->left = parent;
+    }
+    parent->parent = link;
+    link->parent = grandparent;
+    if (NULL == grandparent) {
+        il->root = link;
+    } else if (grandparent->left == parent) {
+        grandparent->left = link;
+    } else {
+        grandparent->right = link;
+    }
+    parent->size = index_link_size(parent->left) + index_link_size(parent->right) + 1;
+    link->size = index_link_size(link->left) + index_link_size(link->right) + 1;
+}   /* index_list_rotate_up() */
+
+/**
+ * Insert @p link into @p il so that it becomes the @p n-th link. If @p n is
+ * greater than the count, @p link is appended.
+ */
+static inline index_link_t* index_list_insert_at(index_list_t* il, size_t n, index_link_t* link) {
+    index_link_t* parent = il->root;
+
+    /* xorshift32 */
+    il->seed ^= il->seed << 13;
+    il->seed ^= il->seed >> 17;
+    il->seed ^= il->seed << 5;
+    link->priority = il->seed;
+    link->left = NULL;
+    link->right = NULL;
+    link->size = 1;
+    link->parent = NULL;
+
+    if (NULL == parent) {
+        il->root = link;
+        return link;
+    }
+    for (;;) {
+        size_t left_size = index_link_size(parent->left);
+        parent->size++;
+        if (n <= left_size) {
+            if (NULL == parent->left) {
+                parent->left = link;
+                break;
+            }
+            parent = parent->left;
+        } else {
+            n -= left_size + 1;
+            if (NULL == parent->right) {
+                parent->right = link;
+                break;
+            }
+            parent = parent->right;
+        }
+    }
+    link->parent = parent;
+    while ((NULL != link->parent) && (link->priority > link->parent->priority)) {
+        index_list_rotate_up(il, link);
+    }
+    return link;
+}   /* index_list_insert_at() */
+
+static inline index_link_t* index_list_append(index_list_t* il, index_link_t* link) {
+    return index_list_insert_at(il, index_list_count(il), link);
+}   /* index_list_append() */
+
+/**
+ * Remove @p link, which must be in @p il.
+ */
+static inline index_link_t* index_list_remove(index_list_t* il, index_link_t* link) {
+    index_link_t* parent = NULL;
+
+    /* Rotate the link down until it is a leaf. */
+    while ((NULL != link->left) || (NULL != link->right)) {
+        index_link_t* child = link->left;
+        if ((NULL == child) || ((NULL != link->right) && (link->right->priority > child->priority))) {
+            child = link->right;
+        }
+        index_list_rotate_up(il, child);
+    }
+    parent = link->parent;
+    if (NULL == parent) {
+        il->root = NULL;
+    } else if (parent->left == link) {
+        parent->left = NULL;
+    } else {
+        parent->right = NULL;
+    }
+    for (; NULL != parent; parent = parent->parent) {
+        parent->size--;
+    }
+    link->parent = NULL;
+    link->size = 1;
+    return link;
+}   /* index_list_remove() */
+
+/**
+ * @return the (0-based) @p n-th link after removing it from @p il, or NULL
+ * if there is none.
+ */
+static inline index_link_t* index_list_remove_at(index_list_t* il, size_t n) {
+    index_link_t* link = index_list_nth(il, n);
+    return (NULL == link) ? NULL : index_list_remove(il, link);
+}   /* index_list_remove_at() */
+
+/**
+ * Using @a _ilp as an index list of structures of type @a _struct_type that
+ * are linked through index_link_t field name @a _link_field_name, for each
+ * struct pointer @a _structp in order, execute @a _code.
+ *
+ * @a _structp may be safely removed from @a _ilp in @a _code.
+ */
+#define index_list_foreach_struct(_ilp,_structp,_struct_type,_link_field_name,_code) \
+    do {                                                                \
+        index_link_t* __link = index_list_first(_ilp);                  \
+        index_link_t* __next = NULL;                                    \
+        for (; NULL != __link; __link = __next) {                       \
+            __next = index_link_next(__link);                           \
+            _struct_type* _structp = STRUCT_CONTAINING_LINK(__link, _struct_type, _link_field_name); \
+            _code ;                                                     \
+        }                                                               \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MALLMOCK_INDEX_LIST_H_
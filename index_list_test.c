@@ -0,0 +1,172 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Unit test program for index_list.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cut.h"
+#include "index_list.h"
+
+const char *g_program_name = "index_list_test"; /**< This program name; overwritten by argv[0]. */
+
+#define TEST_ITEMS  2000
+
+typedef struct item_s {
+    int value;
+    index_link_t link;
+} item_t;
+
+typedef struct test_s {
+    index_list_t il;
+    item_t items[TEST_ITEMS];
+    item_t *order[TEST_ITEMS];  /**< Expected order of items in il. */
+    size_t count;               /**< Number of items in il. */
+} test_t;
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_init(test_t *test) {
+    int i = 0;
+    index_list_init(&test->il);
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        test->items[i].value = i;
+    }
+    srand(1);
+    CUT_TEST_PASS();
+}   /* test_init() */
+
+/* ------------------------------------------------------------------------- */
+static void test_exit(test_t *test) {
+}   /* test_exit() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Check that @p test->il matches @p test->order.
+ */
+static cut_result_t check_order(const char *file, int line, test_t *test) {
+    size_t i = 0;
+    CUT_FL_ASSERT_INT(file, line, test->count, index_list_count(&test->il));
+    for (i = 0; i < test->count; ++i) {
+        CUT_FL_ASSERT_POINTER(file, line, &test->order[i]->link, index_list_nth(&test->il, i));
+        CUT_FL_ASSERT_INT(file, line, i, index_list_index_of(&test->il, &test->order[i]->link));
+    }
+    CUT_FL_ASSERT_NULL(file, line, index_list_nth(&test->il, test->count));
+    i = 0;
+    index_list_foreach_struct(&test->il, item, item_t, link,
+                              if (item != test->order[i]) { break; }
+                              ++i);
+    CUT_FL_ASSERT_INT(file, line, test->count, i);
+    return CUT_RESULT_PASS;
+}   /* check_order() */
+
+#define CHECK_ORDER(_test)  CUT_RETURN(check_order(__FILE__, __LINE__, (_test)))
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_index_list_basic(test_t *test) {
+    index_list_t static_il = INDEX_LIST_INIT;
+
+    CUT_ASSERT(index_list_empty(&static_il));
+    CUT_ASSERT(index_list_empty(&test->il));
+    CUT_ASSERT_NULL(index_list_nth(&test->il, 0));
+    CUT_ASSERT_NULL(index_list_first(&test->il));
+
+    index_list_append(&test->il, &test->items[1].link);
+    index_list_insert_at(&test->il, 0, &test->items[0].link);
+    index_list_insert_at(&test->il, 99, &test->items[3].link);
+    index_list_insert_at(&test->il, 2, &test->items[2].link);
+    test->order[0] = &test->items[0];
+    test->order[1] = &test->items[1];
+    test->order[2] = &test->items[2];
+    test->order[3] = &test->items[3];
+    test->count = 4;
+    CHECK_ORDER(test);
+
+    CUT_ASSERT_POINTER(&test->items[1].link, index_list_remove_at(&test->il, 1));
+    test->order[1] = &test->items[2];
+    test->order[2] = &test->items[3];
+    test->count = 3;
+    CHECK_ORDER(test);
+    CUT_ASSERT_NULL(index_list_remove_at(&test->il, 3));
+    CUT_TEST_PASS();
+}   /* test_index_list_basic() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_index_list_random(test_t *test) {
+    int i = 0;
+
+    /* Insert everything at random positions. */
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        size_t n = (size_t) rand() % (test->count + 1);
+        memmove(&test->order[n + 1], &test->order[n], (test->count - n) * sizeof(test->order[0]));
+        test->order[n] = &test->items[i];
+        test->count++;
+        index_list_insert_at(&test->il, n, &test->items[i].link);
+    }
+    CHECK_ORDER(test);
+
+    /* Remove half at random positions, by link and by index. */
+    for (i = 0; i < TEST_ITEMS / 2; ++i) {
+        size_t n = (size_t) rand() % test->count;
+        if (i & 1) {
+            CUT_ASSERT_POINTER(&test->order[n]->link, index_list_remove(&test->il, &test->order[n]->link));
+        } else {
+            CUT_ASSERT_POINTER(&test->order[n]->link, index_list_remove_at(&test->il, n));
+        }
+        test->count--;
+        memmove(&test->order[n], &test->order[n + 1], (test->count - n) * sizeof(test->order[0]));
+    }
+    CHECK_ORDER(test);
+
+    /* Remove the rest while iterating. */
+    index_list_foreach_struct(&test->il, item, item_t, link,
+                              index_list_remove(&test->il, &item->link));
+    CUT_ASSERT(index_list_empty(&test->il));
+    CUT_TEST_PASS();
+}   /* test_index_list_random() */
+
+/* ------------------------------------------------------------------------- */
+void test_index_list(void) {
+    CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
+    CUT_ADD_TEST(test_index_list_basic);
+    CUT_ADD_TEST(test_index_list_random);
+}   /* test_index_list() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) CUT_GNU_ATTRIBUTE((noexit));
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [test-substring...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "\n");
+    cut_usage(f);
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    int i = 0;
+    g_program_name = argv[0];
+
+    cut_parse_command_line(&argc, argv);
+
+    CUT_INSTALL_SUITE(test_index_list);
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else {
+            if (!cut_include_test(argv[i])) {
+                fprintf(stderr, "%s: no test names match '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+
+    return cut_run(1);
+}   /* main() */
@@ -9,6 +9,7 @@
  */
 #include <stdlib.h>     /* sadly, for NULL. */
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -150,6 +151,386 @@ static inline int list_has_link(list_t* list, link_t* link, int max_count) {
         }                                                               \
     } while (0)
 
+/**
+ * Hint that the link at @a _ptr will be read soon. May be defined before
+ * including this header, e.g. to count prefetches.
+ */
+#ifndef LIST_PREFETCH
+#if defined(__GNUC__)
+#define LIST_PREFETCH(_ptr)     __builtin_prefetch((_ptr))
+#else
+#define LIST_PREFETCH(_ptr)     ((void) (_ptr))
+#endif
+#endif
+
+/**
+ * Like list_foreach_link(), but prefetching the link @a _distance (at
+ * least 1) links ahead of @a _linkp, so that on long lists the cache misses
+ * of the walk overlap with the work done in @a _code.
+ *
+ * Only @a _linkp may be removed from @a _listp in @a _code.
+ */
+#define list_foreach_link_prefetch(_listp,_linkp,_distance,_code)       \
+    do {                                                                \
+        link_t* _linkp = (_listp)->next;                                \
+        link_t* __next = NULL;                                          \
+        link_t* __ahead = _linkp;                                       \
+        int __distance = (_distance);                                   \
+        while ((__distance-- > 0) && (__ahead != (_listp))) {           \
+            __ahead = __ahead->next;                                    \
+        }                                                               \
+        for (; _linkp != (_listp); _linkp = __next) {                   \
+            __next = _linkp->next;                                      \
+            if (__ahead != (_listp)) {                                  \
+                LIST_PREFETCH(__ahead);                                 \
+                __ahead = __ahead->next;                                \
+            }                                                           \
+            _code ;                                                     \
+        }                                                               \
+    } while (0)
+
+/**
+ * Like list_foreach_struct(), but prefetching @a _distance (at least 1)
+ * links ahead, as with list_foreach_link_prefetch().
+ *
+ * Only @a _structp may be removed from @a _listp in @a _code.
+ */
+#define list_foreach_struct_prefetch(_listp,_structp,_struct_type,_link_field_name,_distance,_code) \
+    do {                                                                \
+        link_t* __link = (_listp)->next;                                \
+        link_t* __next = NULL;                                          \
+        link_t* __ahead = __link;                                       \
+        int __distance = (_distance);                                   \
+        while ((__distance-- > 0) && (__ahead != (_listp))) {           \
+            __ahead = __ahead->next;                                    \
+        }                                                               \
+        for (; __link != (_listp); __link = __next) {                   \
+            __next = __link->next;                                      \
+            if (__ahead != (_listp)) {                                  \
+                LIST_PREFETCH(__ahead);                                 \
+                __ahead = __ahead->next;                                \
+            }                                                           \
+            _struct_type* _structp = STRUCT_CONTAINING_LINK(__link, _struct_type, _link_field_name); \
+            _code ;                                                     \
+        }                                                               \
+    } while (0)
+
+/**
+ * Move all links in @p src to the end of @p dst, leaving @p src empty.
+ */
+static inline list_t* list_splice(list_t* dst, list_t* src) {
+    if (!list_empty(src)) {
+        src->next->prev = dst->prev;
+        dst->prev->next = src->next;
+        src->prev->next = dst;
+        dst->prev = src->prev;
+        list_init(src);
+    }
+    return dst;
+}   /* list_splice() */
+
+/**
+ * Move @p link, which must be in @p list, and every link after it to @p
+ * dst, replacing whatever @p dst held.
+ */
+static inline list_t* list_split(list_t* list, link_t* link, list_t* dst) {
+    if (link == list) {
+        return list_init(dst);
+    }
+    dst->next = link;
+    dst->prev = list->prev;
+    list->prev->next = dst;
+    list->prev = link->prev;
+    link->prev->next = list;
+    link->prev = dst;
+    return dst;
+}   /* list_split() */
+
+/**
+ * @return less than, equal to, or greater than zero if @p a sorts before,
+ * with, or after @p b.
+ */
+typedef int (*list_compare_func_t)(const link_t* a, const link_t* b, void* context);
+
+/**
+ * Merge two NULL-terminated runs linked through their next pointers. Links
+ * of @p a come first among equals.
+ */
+static inline link_t* list_merge_runs(link_t* a, link_t* b, list_compare_func_t compare, void* context) {
+    link_t* head = NULL;
+    link_t** tail = &head;
+    while ((NULL != a) && (NULL != b)) {
+        if (compare(a, b, context) <= 0) {
+            *tail = a;
+            a = a->next;
+        } else {
+            *tail = b;
+            b = b->next;
+        }
+        tail = &(*tail)->next;
+    }
+    *tail = (NULL != a) ? a : b;
+    return head;
+}   /* list_merge_runs() */
+
+/**
+ * Sort @p list with a stable, bottom-up merge sort that needs no memory
+ * beyond a small array on the stack.
+ *
+ * Links are taken one at a time and merged into a binary counter of
+ * pending runs, where pending[i] is empty or holds 2^i links, so runs of
+ * equal size are always merged and the work is O(n log n).
+ */
+static inline list_t* list_sort(list_t* list, list_compare_func_t compare, void* context) {
+    link_t* pending[8 * sizeof(size_t)] = { NULL };
+    link_t* link = list->next;
+    link_t* run = NULL;
+    link_t* prev = list;
+    size_t i = 0;
+
+    if (link == list->prev) {
+        return list;    /* Zero or one links. */
+    }
+    list->prev->next = NULL;
+    while (NULL != link) {
+        link_t* next = link->next;
+        link->next = NULL;
+        run = link;
+        for (i = 0; NULL != pending[i]; ++i) {
+            run = list_merge_runs(pending[i], run, compare, context);
+            pending[i] = NULL;
+        }
+        pending[i] = run;
+        link = next;
+    }
+    run = NULL;
+    for (i = 0; i < sizeof(pending) / sizeof(pending[0]); ++i) {
+        if (NULL != pending[i]) {
+            run = (NULL == run) ? pending[i] : list_merge_runs(pending[i], run, compare, context);
+        }
+    }
+
+    /* Rebuild the prev pointers. */
+    list->next = run;
+    for (link = run; NULL != link; link = link->next) {
+        link->prev = prev;
+        prev = link;
+    }
+    prev->next = list;
+    list->prev = prev;
+    return list;
+}   /* list_sort() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * A lock-free LIFO stack of links, for free lists and object pools shared
+ * between threads. Only each link's next pointer is used. Embed a link_t in
+ * your struct and use STRUCT_CONTAINING_LINK() on popped links, as with
+ * list_t.
+ *
+ * The head carries a tag that changes with every pop, so a pop that read a
+ * stale head cannot succeed even if the same link has since been pushed
+ * back (the ABA problem). The tag sits beside the pointer when the compiler
+ * has a double-width compare-and-swap (on x86-64, build with -mcx16);
+ * otherwise it is packed into the top 16 bits of a 64-bit pointer, which
+ * are unused by user-space addresses.
+ *
+ * A pop may read the next pointer of a link that another thread has just
+ * popped, so memory holding links must not be unmapped while the stack is
+ * in use. Returning it to a pool, or to malloc(), is fine.
+ */
+#if (UINTPTR_MAX == 0xFFFFFFFFu) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+#define LF_STACK_DOUBLE_WORD 1
+typedef uint64_t lf_stack_dword_t;
+#elif (UINTPTR_MAX > 0xFFFFFFFFu) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define LF_STACK_DOUBLE_WORD 1
+typedef unsigned __int128 lf_stack_dword_t;
+#elif (UINTPTR_MAX > 0xFFFFFFFFu)
+#define LF_STACK_TAG_SHIFT   48
+#define LF_STACK_LINK_MASK   ((((uintptr_t) 1) << LF_STACK_TAG_SHIFT) - 1)
+#else
+#error "No way to tag lf_stack_t pointers on this target."
+#endif
+
+typedef struct lf_stack_s {
+#if defined(LF_STACK_DOUBLE_WORD)
+    union {
+        lf_stack_dword_t word;
+        struct {
+            link_t* top;
+            uintptr_t tag;
+        } s;
+    } head;
+#else
+    uintptr_t head;     /**< Tag in the top bits, link pointer in the rest. */
+#endif
+} lf_stack_t;
+
+/**
+ * Intended usage:
+ *
+ *    lf_stack_t g_my_free_links = LF_STACK_INIT;
+ */
+#define LF_STACK_INIT { 0 }
+
+static inline lf_stack_t* lf_stack_init(lf_stack_t* stack) {
+    lf_stack_t empty = LF_STACK_INIT;
+    *stack = empty;
+    return stack;
+}   /* lf_stack_init() */
+
+/**
+ * Read the top link and tag of @p stack. They may be torn, but then the
+ * compare-and-swap in lf_stack_replace() will fail.
+ */
+static inline link_t* lf_stack_peek(lf_stack_t* stack, uintptr_t* tag) {
+#if defined(LF_STACK_DOUBLE_WORD)
+    *tag = __atomic_load_n(&stack->head.s.tag, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&stack->head.s.top, __ATOMIC_ACQUIRE);
+#else
+    uintptr_t head = __atomic_load_n(&stack->head, __ATOMIC_ACQUIRE);
+    *tag = head >> LF_STACK_TAG_SHIFT;
+    return (link_t*) (head & LF_STACK_LINK_MASK);
+#endif
+}   /* lf_stack_peek() */
+
+/**
+ * Replace the head of @p stack if it still holds @p old_top and @p old_tag.
+ *
+ * @return 1 on success, 0 if someone else changed it first.
+ */
+static inline int lf_stack_replace(lf_stack_t* stack, link_t* old_top, uintptr_t old_tag,
+                                   link_t* new_top, uintptr_t new_tag) {
+#if defined(LF_STACK_DOUBLE_WORD)
+    lf_stack_t old_head;
+    lf_stack_t new_head;
+    old_head.head.s.top = old_top;
+    old_head.head.s.tag = old_tag;
+    new_head.head.s.top = new_top;
+    new_head.head.s.tag = new_tag;
+    return __sync_bool_compare_and_swap(&stack->head.word, old_head.head.word, new_head.head.word);
+#else
+    uintptr_t old_head = (old_tag << LF_STACK_TAG_SHIFT) | (uintptr_t) old_top;
+    uintptr_t new_head = (new_tag << LF_STACK_TAG_SHIFT) | (uintptr_t) new_top;
+    return __atomic_compare_exchange_n(&stack->head, &old_head, new_head, 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+}   /* lf_stack_replace() */
+
+/**
+ * @return 1 if @p stack was empty when checked, which may no longer be true.
+ */
+static inline int lf_stack_empty(lf_stack_t* stack) {
+    uintptr_t tag;
+    return NULL == lf_stack_peek(stack, &tag);
+}   /* lf_stack_empty() */
+
+static inline link_t* lf_stack_push(lf_stack_t* stack, link_t* link) {
+    uintptr_t tag;
+    link_t* top;
+    do {
+        top = lf_stack_peek(stack, &tag);
+        link->next = top;
+    } while (!lf_stack_replace(stack, top, tag, link, tag));
+    return link;
+}   /* lf_stack_push() */
+
+/**
+ * @return the most recently pushed link, or NULL if @p stack is empty.
+ */
+static inline link_t* lf_stack_pop(lf_stack_t* stack) {
+    uintptr_t tag;
+    link_t* top;
+    link_t* next;
+    do {
+        top = lf_stack_peek(stack, &tag);
+        if (NULL == top) {
+            return NULL;
+        }
+        next = __atomic_load_n(&top->next, __ATOMIC_RELAXED);
+    } while (!lf_stack_replace(stack, top, tag, next, tag + 1));
+    return top;
+}   /* lf_stack_pop() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * An intrusive multi-producer, single-consumer FIFO queue of links (after
+ * Dmitry Vyukov). Any number of threads may push at once, without waiting
+ * on each other; only one thread may pop. Only each link's next pointer is
+ * used, and nothing is allocated.
+ *
+ * A pop can return NULL while a producer is part way through a push, even
+ * though the queue is not empty; the consumer should simply try again.
+ */
+typedef struct mpsc_queue_s {
+    link_t* head;       /**< Most recently pushed link; shared by producers. */
+    char pad[64 - sizeof(link_t*)];     /**< Keep producers off the consumer's line. */
+    link_t* tail;       /**< Oldest link; used only by the consumer. */
+    link_t stub;        /**< Placeholder so the queue is never truly empty. */
+} mpsc_queue_t;
+
+/**
+ * Intended usage:
+ *
+ *    mpsc_queue_t MPSC_QUEUE_INIT(g_my_queue);
+ */
+#define MPSC_QUEUE_INIT(_variable_name) \
+    _variable_name = { &_variable_name.stub, { 0 }, &_variable_name.stub, { NULL, NULL } }
+
+static inline mpsc_queue_t* mpsc_queue_init(mpsc_queue_t* queue) {
+    queue->stub.next = NULL;
+    queue->stub.prev = NULL;
+    queue->head = &queue->stub;
+    queue->tail = &queue->stub;
+    return queue;
+}   /* mpsc_queue_init() */
+
+/**
+ * Add @p link to the end of @p queue. Safe to call from any thread.
+ */
+static inline link_t* mpsc_queue_push(mpsc_queue_t* queue, link_t* link) {
+    link_t* prev = NULL;
+    __atomic_store_n(&link->next, NULL, __ATOMIC_RELAXED);
+    prev = __atomic_exchange_n(&queue->head, link, __ATOMIC_ACQ_REL);
+    /* Between these two steps, the consumer cannot see past 'prev'. */
+    __atomic_store_n(&prev->next, link, __ATOMIC_RELEASE);
+    return link;
+}   /* mpsc_queue_push() */
+
+/**
+ * Remove the oldest link from @p queue. Only one thread may call this.
+ *
+ * @return the oldest link, or NULL if the queue is empty or a push is in
+ * progress.
+ */
+static inline link_t* mpsc_queue_pop(mpsc_queue_t* queue) {
+    link_t* tail = queue->tail;
+    link_t* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (&queue->stub == tail) {
+        if (NULL == next) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+    if (NULL != next) {
+        queue->tail = next;
+        return tail;
+    }
+    if (tail != __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE)) {
+        return NULL;    /* A producer has swapped in but not linked yet. */
+    }
+    /* 'tail' is the last link. Put the stub behind it so it can be taken. */
+    mpsc_queue_push(queue, &queue->stub);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (NULL != next) {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}   /* mpsc_queue_pop() */
+
 #ifdef __cplusplus
 }
 #endif
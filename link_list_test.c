@@ -0,0 +1,458 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Unit test program for link_list.h.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_ITEMS      64
+
+static const void *g_prefetched[TEST_ITEMS];    /**< Links prefetched by the list_foreach_*_prefetch() walks. */
+static int g_prefetch_count = 0;
+
+/* ------------------------------------------------------------------------- */
+static void record_prefetch(const void *ptr) {
+    if (g_prefetch_count < TEST_ITEMS) {
+        g_prefetched[g_prefetch_count] = ptr;
+    }
+    g_prefetch_count++;
+}   /* record_prefetch() */
+
+#define LIST_PREFETCH(_ptr)     record_prefetch((_ptr))
+
+#include "cut.h"
+#include "link_list.h"
+
+const char *g_program_name = "link_list_test"; /**< This program name; overwritten by argv[0]. */
+
+#define TEST_THREADS    4
+#define TEST_ITERATIONS 100000
+
+#define TEST_PRODUCERS  3
+#define TEST_MESSAGES   20000   /**< Per producer. */
+
+typedef struct item_s {
+    int value;
+    int producer;
+    link_t link;
+} item_t;
+
+typedef struct test_s test_t;
+
+typedef struct producer_s {
+    test_t *test;
+    int id;
+} producer_t;
+
+struct test_s {
+    item_t items[TEST_ITEMS];
+    list_t list;
+    lf_stack_t stack;
+    mpsc_queue_t queue;
+    producer_t producers[TEST_PRODUCERS];
+    item_t *messages;   /**< TEST_PRODUCERS * TEST_MESSAGES items. */
+};
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_init(test_t *test) {
+    int i = 0;
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        test->items[i].value = i;
+    }
+    list_init(&test->list);
+    g_prefetch_count = 0;
+    lf_stack_init(&test->stack);
+    mpsc_queue_init(&test->queue);
+    CUT_TEST_PASS();
+}   /* test_init() */
+
+/* ------------------------------------------------------------------------- */
+static void test_exit(test_t *test) {
+    free(test->messages);
+    test->messages = NULL;
+}   /* test_exit() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_list_basic(test_t *test) {
+    int expected = 0;
+
+    CUT_ASSERT(list_empty(&test->list));
+    list_insert_prev(&test->list, &test->items[1].link);
+    list_insert_prev(&test->list, &test->items[2].link);
+    list_insert_next(&test->list, &test->items[0].link);
+    CUT_ASSERT(!list_empty(&test->list));
+    CUT_ASSERT(list_has_link(&test->list, &test->items[2].link, 3));
+    CUT_ASSERT(!list_has_link(&test->list, &test->items[2].link, 2));
+    list_foreach_struct(&test->list, item, item_t, link,
+                        if (item->value != expected) { break; }
+                        expected++);
+    CUT_ASSERT_INT(3, expected);
+    CUT_ASSERT_POINTER(&test->items[2].link, list_remove_prev(&test->list));
+    CUT_ASSERT_POINTER(&test->items[0].link, list_pop(&test->list));
+    CUT_ASSERT_POINTER(&test->items[1].link, list_pop(&test->list));
+    CUT_ASSERT_NULL(list_pop(&test->list));
+    CUT_TEST_PASS();
+}   /* test_list_basic() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_list_splice_split(test_t *test) {
+    list_t LIST_INIT(other);
+    int expected = 0;
+    int i = 0;
+
+    for (i = 0; i < 4; ++i) {
+        list_insert_prev(&test->list, &test->items[i].link);
+        list_insert_prev(&other, &test->items[4 + i].link);
+    }
+    list_splice(&test->list, &other);
+    CUT_ASSERT(list_empty(&other));
+    list_splice(&test->list, &other);
+    list_foreach_struct(&test->list, item, item_t, link,
+                        if (item->value != expected) { break; }
+                        expected++);
+    CUT_ASSERT_INT(8, expected);
+
+    list_split(&test->list, &test->items[5].link, &other);
+    CUT_ASSERT_POINTER(&test->items[4].link, test->list.prev);
+    expected = 5;
+    list_foreach_struct(&other, item, item_t, link,
+                        if (item->value != expected) { break; }
+                        expected++);
+    CUT_ASSERT_INT(8, expected);
+    CUT_ASSERT_POINTER(&test->items[7].link, list_remove_prev(&other));
+
+    list_split(&test->list, &test->list, &other);
+    CUT_ASSERT(list_empty(&other));
+    list_split(&test->list, test->list.next, &other);
+    CUT_ASSERT(list_empty(&test->list));
+    CUT_ASSERT_POINTER(&test->items[0].link, list_pop(&other));
+    CUT_TEST_PASS();
+}   /* test_list_splice_split() */
+
+/* ------------------------------------------------------------------------- */
+static int compare_items(const link_t *a, const link_t *b, void *context) {
+    int modulus = *(int *) context;
+    return (STRUCT_CONTAINING_LINK(a, item_t, link)->value % modulus) -
+        (STRUCT_CONTAINING_LINK(b, item_t, link)->value % modulus);
+}   /* compare_items() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_list_sort(test_t *test) {
+    int modulus = 7;
+    int count = 0;
+    item_t *prev = NULL;
+    int i = 0;
+
+    list_sort(&test->list, compare_items, &modulus);
+    CUT_ASSERT(list_empty(&test->list));
+    list_insert_prev(&test->list, &test->items[8].link);
+    list_sort(&test->list, compare_items, &modulus);
+    CUT_ASSERT_POINTER(&test->items[8].link, list_pop(&test->list));
+
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        list_insert_prev(&test->list, &test->items[i].link);
+    }
+    list_sort(&test->list, compare_items, &modulus);
+
+    /* Sorted by value % modulus, and by value among equals. */
+    list_foreach_struct(&test->list, item, item_t, link,
+                        if ((NULL != prev) && (compare_items(&prev->link, &item->link, &modulus) > 0)) { break; }
+                        if ((NULL != prev) && (compare_items(&prev->link, &item->link, &modulus) == 0) &&
+                            (prev->value > item->value)) { break; }
+                        prev = item;
+                        count++);
+    CUT_ASSERT_INT(TEST_ITEMS, count);
+    CUT_ASSERT_POINTER(test->list.prev, &prev->link);
+    CUT_ASSERT_POINTER(&test->items[0].link, test->list.next);
+    CUT_TEST_PASS();
+}   /* test_list_sort() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_list_foreach_prefetch(test_t *test) {
+    int expected = 0;
+    int i = 0;
+
+    for (i = 0; i < 10; ++i) {
+        list_insert_prev(&test->list, &test->items[i].link);
+    }
+    list_foreach_link_prefetch(&test->list, link, 3,
+                               if (link != &test->items[expected].link) { break; }
+                               expected++);
+    CUT_ASSERT_INT(10, expected);
+
+    /* Visiting item i prefetches item i + 3, until the end of the list. */
+    CUT_ASSERT_INT(7, g_prefetch_count);
+    for (i = 0; i < 7; ++i) {
+        CUT_ASSERT_POINTER(&test->items[i + 3].link, g_prefetched[i]);
+    }
+
+    expected = 0;
+    g_prefetch_count = 0;
+    list_foreach_struct_prefetch(&test->list, item, item_t, link, 1,
+                                 if (item->value != expected) { break; }
+                                 expected++);
+    CUT_ASSERT_INT(10, expected);
+    CUT_ASSERT_INT(9, g_prefetch_count);
+    for (i = 0; i < 9; ++i) {
+        CUT_ASSERT_POINTER(&test->items[i + 1].link, g_prefetched[i]);
+    }
+    CUT_TEST_PASS();
+}   /* test_list_foreach_prefetch() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_list_foreach_prefetch_short(test_t *test) {
+    int count = 0;
+    int i = 0;
+
+    list_foreach_link_prefetch(&test->list, link, 4, count++);
+    list_foreach_struct_prefetch(&test->list, item, item_t, link, 4, count += item->value + 1);
+    CUT_ASSERT_INT(0, count);
+    CUT_ASSERT_INT(0, g_prefetch_count);
+
+    /* A distance past the end of the list prefetches nothing. */
+    for (i = 0; i < 3; ++i) {
+        list_insert_prev(&test->list, &test->items[i].link);
+    }
+    list_foreach_link_prefetch(&test->list, link, 10,
+                               if (link != &test->items[count].link) { break; }
+                               count++);
+    CUT_ASSERT_INT(3, count);
+    count = 0;
+    list_foreach_struct_prefetch(&test->list, item, item_t, link, 3,
+                                 if (item->value != count) { break; }
+                                 count++);
+    CUT_ASSERT_INT(3, count);
+    CUT_ASSERT_INT(0, g_prefetch_count);
+    CUT_TEST_PASS();
+}   /* test_list_foreach_prefetch_short() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_list_foreach_prefetch_remove(test_t *test) {
+    int visited = 0;
+    int expected = 0;
+    int i = 0;
+
+    for (i = 0; i < 10; ++i) {
+        list_insert_prev(&test->list, &test->items[i].link);
+    }
+    list_foreach_struct_prefetch(&test->list, item, item_t, link, 2,
+                                 if (item->value != visited) { break; }
+                                 if (1 == item->value % 2) { link_remove(&item->link); }
+                                 visited++);
+    CUT_ASSERT_INT(10, visited);
+    list_foreach_struct(&test->list, item, item_t, link,
+                        if (item->value != expected) { break; }
+                        expected += 2);
+    CUT_ASSERT_INT(10, expected);
+
+    visited = 0;
+    list_foreach_link_prefetch(&test->list, link, 1,
+                               if (link != &test->items[2 * visited].link) { break; }
+                               link_remove(link);
+                               visited++);
+    CUT_ASSERT_INT(5, visited);
+    CUT_ASSERT(list_empty(&test->list));
+    CUT_TEST_PASS();
+}   /* test_list_foreach_prefetch_remove() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_lf_stack_basic(test_t *test) {
+    link_t *link = NULL;
+
+    CUT_ASSERT(lf_stack_empty(&test->stack));
+    CUT_ASSERT_NULL(lf_stack_pop(&test->stack));
+    lf_stack_push(&test->stack, &test->items[0].link);
+    lf_stack_push(&test->stack, &test->items[1].link);
+    lf_stack_push(&test->stack, &test->items[2].link);
+    CUT_ASSERT(!lf_stack_empty(&test->stack));
+    CUT_ASSERT_NOT_NULL(link = lf_stack_pop(&test->stack));
+    CUT_ASSERT_INT(2, STRUCT_CONTAINING_LINK(link, item_t, link)->value);
+    CUT_ASSERT_NOT_NULL(link = lf_stack_pop(&test->stack));
+    CUT_ASSERT_INT(1, STRUCT_CONTAINING_LINK(link, item_t, link)->value);
+    lf_stack_push(&test->stack, link);
+    CUT_ASSERT_POINTER(link, lf_stack_pop(&test->stack));
+    CUT_ASSERT_POINTER(&test->items[0].link, lf_stack_pop(&test->stack));
+    CUT_ASSERT_NULL(lf_stack_pop(&test->stack));
+    CUT_TEST_PASS();
+}   /* test_lf_stack_basic() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Pop a few links and push them back, over and over.
+ */
+static void *lf_stack_thread(void *arg) {
+    test_t *test = (test_t *) arg;
+    link_t *held[3];
+    int i = 0;
+    int j = 0;
+    for (i = 0; i < TEST_ITERATIONS; ++i) {
+        int count = 1 + (i % 3);
+        for (j = 0; j < count; ++j) {
+            held[j] = lf_stack_pop(&test->stack);
+        }
+        while (j-- > 0) {
+            if (NULL != held[j]) {
+                lf_stack_push(&test->stack, held[j]);
+            }
+        }
+    }
+    return NULL;
+}   /* lf_stack_thread() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_lf_stack_threads(test_t *test) {
+    pthread_t threads[TEST_THREADS];
+    int seen[TEST_ITEMS];
+    link_t *link = NULL;
+    int count = 0;
+    int i = 0;
+
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        lf_stack_push(&test->stack, &test->items[i].link);
+    }
+    for (i = 0; i < TEST_THREADS; ++i) {
+        CUT_ASSERT_INT(0, pthread_create(&threads[i], NULL, lf_stack_thread, test));
+    }
+    for (i = 0; i < TEST_THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    /* Every item must come back exactly once. */
+    memset(seen, 0, sizeof(seen));
+    while (NULL != (link = lf_stack_pop(&test->stack))) {
+        item_t *item = STRUCT_CONTAINING_LINK(link, item_t, link);
+        CUT_ASSERT_INT_IN(0, TEST_ITEMS - 1, item->value);
+        CUT_ASSERT_INT(0, seen[item->value]);
+        seen[item->value] = 1;
+        count++;
+    }
+    CUT_ASSERT_INT(TEST_ITEMS, count);
+    CUT_TEST_PASS();
+}   /* test_lf_stack_threads() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_mpsc_queue_basic(test_t *test) {
+    mpsc_queue_t MPSC_QUEUE_INIT(queue);
+
+    CUT_ASSERT_NULL(mpsc_queue_pop(&queue));
+    mpsc_queue_push(&queue, &test->items[0].link);
+    CUT_ASSERT_POINTER(&test->items[0].link, mpsc_queue_pop(&queue));
+    CUT_ASSERT_NULL(mpsc_queue_pop(&queue));
+
+    mpsc_queue_push(&test->queue, &test->items[0].link);
+    mpsc_queue_push(&test->queue, &test->items[1].link);
+    mpsc_queue_push(&test->queue, &test->items[2].link);
+    CUT_ASSERT_POINTER(&test->items[0].link, mpsc_queue_pop(&test->queue));
+    mpsc_queue_push(&test->queue, &test->items[3].link);
+    CUT_ASSERT_POINTER(&test->items[1].link, mpsc_queue_pop(&test->queue));
+    CUT_ASSERT_POINTER(&test->items[2].link, mpsc_queue_pop(&test->queue));
+    CUT_ASSERT_POINTER(&test->items[3].link, mpsc_queue_pop(&test->queue));
+    CUT_ASSERT_NULL(mpsc_queue_pop(&test->queue));
+    mpsc_queue_push(&test->queue, &test->items[4].link);
+    CUT_ASSERT_POINTER(&test->items[4].link, mpsc_queue_pop(&test->queue));
+    CUT_ASSERT_NULL(mpsc_queue_pop(&test->queue));
+    CUT_TEST_PASS();
+}   /* test_mpsc_queue_basic() */
+
+/* ------------------------------------------------------------------------- */
+static void *mpsc_producer_thread(void *arg) {
+    producer_t *producer = (producer_t *) arg;
+    test_t *test = producer->test;
+    item_t *messages = &test->messages[producer->id * TEST_MESSAGES];
+    int i = 0;
+    for (i = 0; i < TEST_MESSAGES; ++i) {
+        messages[i].producer = producer->id;
+        messages[i].value = i;
+        mpsc_queue_push(&test->queue, &messages[i].link);
+    }
+    return NULL;
+}   /* mpsc_producer_thread() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_mpsc_queue_threads(test_t *test) {
+    pthread_t threads[TEST_PRODUCERS];
+    int next_value[TEST_PRODUCERS];
+    int received = 0;
+    int i = 0;
+
+    CUT_ASSERT_NOT_NULL(test->messages = calloc(TEST_PRODUCERS * TEST_MESSAGES, sizeof(item_t)));
+    for (i = 0; i < TEST_PRODUCERS; ++i) {
+        test->producers[i].test = test;
+        test->producers[i].id = i;
+        next_value[i] = 0;
+        CUT_ASSERT_INT(0, pthread_create(&threads[i], NULL, mpsc_producer_thread, &test->producers[i]));
+    }
+
+    /* Each producer's messages must arrive in order. */
+    while (received < TEST_PRODUCERS * TEST_MESSAGES) {
+        link_t *link = mpsc_queue_pop(&test->queue);
+        if (NULL != link) {
+            item_t *item = STRUCT_CONTAINING_LINK(link, item_t, link);
+            CUT_ASSERT_INT_IN(0, TEST_PRODUCERS - 1, item->producer);
+            CUT_ASSERT_INT(next_value[item->producer], item->value);
+            next_value[item->producer]++;
+            received++;
+        }
+    }
+    for (i = 0; i < TEST_PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    CUT_ASSERT_NULL(mpsc_queue_pop(&test->queue));
+    CUT_TEST_PASS();
+}   /* test_mpsc_queue_threads() */
+
+/* ------------------------------------------------------------------------- */
+void test_link_list(void) {
+    CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
+    CUT_ADD_TEST(test_list_basic);
+    CUT_ADD_TEST(test_list_splice_split);
+    CUT_ADD_TEST(test_list_sort);
+    CUT_ADD_TEST(test_list_foreach_prefetch);
+    CUT_ADD_TEST(test_list_foreach_prefetch_short);
+    CUT_ADD_TEST(test_list_foreach_prefetch_remove);
+    CUT_ADD_TEST(test_lf_stack_basic);
+    CUT_ADD_TEST(test_lf_stack_threads);
+    CUT_ADD_TEST(test_mpsc_queue_basic);
+    CUT_ADD_TEST(test_mpsc_queue_threads);
+}   /* test_link_list() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) CUT_GNU_ATTRIBUTE((noexit));
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [test-substring...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "\n");
+    cut_usage(f);
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    int i = 0;
+    g_program_name = argv[0];
+
+    cut_parse_command_line(&argc, argv);
+
+    CUT_INSTALL_SUITE(test_link_list);
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else {
+            if (!cut_include_test(argv[i])) {
+                fprintf(stderr, "%s: no test names match '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+
+    return cut_run(1);
+}   /* main() */
@@ -0,0 +1,226 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Traversal benchmark for the list containers.
+ *
+ * Each element carries a value and some payload, about the size of a short
+ * line from read_file.c. Each container is walked, summing the values, and
+ * the time per element is printed to stdout as CSV:
+ *
+ * - list_seq, a list_t linked in allocation order.
+ * - list_shuffled, a list_t linked in random order, as a long-lived heap
+ *   tends to end up.
+ * - ulist, an unrolled list holding the elements inline.
+ *
+ * The list_t walks are also timed with list_foreach_struct_prefetch(), as
+ * list_seq_prefetch and list_shuffled_prefetch.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "link_list.h"
+#include "unrolled_list.h"
+
+const char *g_program_name = "list_bench"; /**< This program name; overwritten by argv[0]. */
+
+#define PAYLOAD_SIZE    48
+#define MAX_SIZES       16
+
+static int g_prefetch_distance = 4; /**< Distance for the prefetching walks. */
+
+typedef struct node_s {
+    link_t link;
+    uint64_t value;
+    char payload[PAYLOAD_SIZE];
+} node_t;
+
+typedef struct element_s {
+    uint64_t value;
+    char payload[PAYLOAD_SIZE];
+} element_t;
+
+/* ------------------------------------------------------------------------- */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}   /* now_ns() */
+
+/* ------------------------------------------------------------------------- */
+static uint64_t sum_list(void *arg) {
+    list_t *list = (list_t *) arg;
+    uint64_t sum = 0;
+    list_foreach_struct(list, node, node_t, link, sum += node->value);
+    return sum;
+}   /* sum_list() */
+
+/* ------------------------------------------------------------------------- */
+static uint64_t sum_list_prefetch(void *arg) {
+    list_t *list = (list_t *) arg;
+    uint64_t sum = 0;
+    list_foreach_struct_prefetch(list, node, node_t, link, g_prefetch_distance, sum += node->value);
+    return sum;
+}   /* sum_list_prefetch() */
+
+/* ------------------------------------------------------------------------- */
+static uint64_t sum_ulist(void *arg) {
+    ulist_t *ul = (ulist_t *) arg;
+    uint64_t sum = 0;
+    ulist_foreach(ul, element, element_t, sum += element->value);
+    return sum;
+}   /* sum_ulist() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Time @p repeat calls of @p sum over @p container, which has @p count
+ * elements, and print a CSV row named @p name.
+ *
+ * @return 1 if every call gave @p expected, 0 otherwise.
+ */
+static int time_sum(const char *name, uint64_t (*sum)(void *), void *container,
+                    size_t count, int repeat, uint64_t expected) {
+    uint64_t start = 0;
+    uint64_t elapsed = 0;
+    int ok = 1;
+    int i = 0;
+
+    ok = (sum(container) == expected);     /* Warm up. */
+    start = now_ns();
+    for (i = 0; i < repeat; ++i) {
+        ok = ok && (sum(container) == expected);
+    }
+    elapsed = now_ns() - start;
+    printf("%s,%zu,%.2f\n", name, count, (double) elapsed / ((double) count * repeat));
+    fflush(stdout);
+    return ok;
+}   /* time_sum() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Run the benchmark for @p count elements.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int bench_size(size_t count, int repeat) {
+    node_t **nodes = NULL;
+    list_t LIST_INIT(list);
+    ulist_t ul;
+    uint64_t expected = 0;
+    size_t i = 0;
+    int ok = 1;
+
+    ulist_init(&ul, sizeof(element_t));
+    nodes = calloc(count, sizeof(node_t *));
+    if (NULL == nodes) {
+        return 0;
+    }
+    for (i = 0; i < count; ++i) {
+        element_t element;
+        nodes[i] = calloc(1, sizeof(node_t));
+        if (NULL == nodes[i]) {
+            ok = 0;
+            goto Done;
+        }
+        nodes[i]->value = i;
+        memset(&element, 0, sizeof(element));
+        element.value = i;
+        if (NULL == ulist_append(&ul, &element)) {
+            ok = 0;
+            goto Done;
+        }
+        expected += i;
+    }
+
+    for (i = 0; i < count; ++i) {
+        list_insert_prev(&list, &nodes[i]->link);
+    }
+    ok = ok && time_sum("list_seq", sum_list, &list, count, repeat, expected);
+    ok = ok && time_sum("list_seq_prefetch", sum_list_prefetch, &list, count, repeat, expected);
+
+    /* Relink in a random order. */
+    for (i = count - 1; i > 0; --i) {
+        size_t j = (size_t) (((uint64_t) rand() << 31 | rand()) % (i + 1));
+        node_t *swap = nodes[i];
+        nodes[i] = nodes[j];
+        nodes[j] = swap;
+    }
+    list_init(&list);
+    for (i = 0; i < count; ++i) {
+        list_insert_prev(&list, &nodes[i]->link);
+    }
+    ok = ok && time_sum("list_shuffled", sum_list, &list, count, repeat, expected);
+    ok = ok && time_sum("list_shuffled_prefetch", sum_list_prefetch, &list, count, repeat, expected);
+
+    ok = ok && time_sum("ulist", sum_ulist, &ul, count, repeat, expected);
+
+Done:
+    for (i = 0; i < count; ++i) {
+        free(nodes[i]);
+    }
+    free(nodes);
+    ulist_clear(&ul);
+    return ok;
+}   /* bench_size() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [element-count...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "  -p <distance>                 Links to prefetch ahead [%d].\n", g_prefetch_distance);
+    fprintf(f, "  -r <repeat>                   Number of timed walks per container [5].\n");
+    fprintf(f, "\n");
+    fprintf(f, "  Element counts default to 1000000 and 4000000.\n");
+    fprintf(f, "\n");
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    size_t sizes[MAX_SIZES] = { 1000000, 4000000 };
+    int size_count = 0;
+    int repeat = 5;
+    int ok = 1;
+    int i = 0;
+
+    g_program_name = argv[0];
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-p"))) {
+            g_prefetch_distance = atoi(argv[++i]);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-r"))) {
+            repeat = atoi(argv[++i]);
+        } else if ((argv[i][0] >= '1') && (argv[i][0] <= '9') && (size_count < MAX_SIZES)) {
+            sizes[size_count++] = (size_t) strtoull(argv[i], NULL, 0);
+        } else {
+            fprintf(stderr, "%s: unknown option '%s'\n", g_program_name, argv[i]);
+            fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+            exit(1);
+        }
+    }
+    if (0 == size_count) {
+        size_count = 2;
+    }
+    if (repeat < 1) {
+        repeat = 1;
+    }
+    if (g_prefetch_distance < 1) {
+        g_prefetch_distance = 1;
+    }
+
+    printf("container,elements,ns_per_element\n");
+    for (i = 0; i < size_count; ++i) {
+        if (!bench_size(sizes[i], repeat)) {
+            fprintf(stderr, "%s: failed with %zu elements\n", g_program_name, sizes[i]);
+            ok = 0;
+        }
+    }
+    return ok ? 0 : 1;
+}   /* main() */
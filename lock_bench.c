@@ -0,0 +1,310 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Microbenchmark for the locks in spin_lock.h.
+ *
+ * Each lock is run with 1..N threads. Every thread repeatedly takes the
+ * lock, does some work inside it, releases it, then does some work outside
+ * it. Results are printed to stdout as CSV, one row per lock and thread
+ * count:
+ *
+ * - ops_per_sec, total acquisitions per second across all threads.
+ * - min_thread_ops/max_thread_ops, the spread of per-thread acquisitions; a
+ *   fair lock keeps these close.
+ * - p50_acquire_ns/p99_acquire_ns, the time taken to acquire the lock.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spin_lock.h"
+
+const char *g_program_name = "lock_bench"; /**< This program name; overwritten by argv[0]. */
+
+#define MAX_THREADS         256
+#define LATENCY_SAMPLES     0x4000  /**< Per thread; power of 2. */
+
+/**
+ * One of every lock type; the benchmark uses one at a time.
+ */
+typedef struct bench_locks_s {
+    spin_lock_t spin;
+    spin_ticket_lock_t ticket;
+    spin_mcs_lock_t mcs;
+    spin_adaptive_lock_t adaptive;
+    spin_rwlock_t rwlock;
+    spin_seqlock_t seqlock;
+} bench_locks_t;
+
+typedef struct lock_type_s {
+    const char *name;
+    void (*acquire)(bench_locks_t *locks, spin_mcs_node_t *node);
+    void (*release)(bench_locks_t *locks, spin_mcs_node_t *node);
+} lock_type_t;
+
+typedef struct bench_s bench_t;
+
+typedef struct bench_thread_s {
+    bench_t *bench;
+    pthread_t thread;
+    uint64_t ops;                                   /**< Acquisitions made. */
+    uint32_t latency_ns[LATENCY_SAMPLES];           /**< Ring of acquire times. */
+    char pad[64];                                   /**< Keep threads' data apart. */
+} bench_thread_t;
+
+struct bench_s {
+    const lock_type_t *lock_type;
+    bench_locks_t locks;
+    volatile uint64_t shared;   /**< Data protected by the lock. */
+    int go;                     /**< Set when all threads should start. */
+    int stop;                   /**< Set when all threads should stop. */
+    unsigned cs_work;           /**< Work loop count inside the lock. */
+    unsigned think_work;        /**< Work loop count outside the lock. */
+    bench_thread_t *threads;
+};
+
+/* ------------------------------------------------------------------------- */
+static void spin_acquire(bench_locks_t *l, spin_mcs_node_t *n) { spin_lock_acquire(&l->spin); }
+static void spin_release(bench_locks_t *l, spin_mcs_node_t *n) { spin_lock_release(&l->spin); }
+static void ticket_acquire(bench_locks_t *l, spin_mcs_node_t *n) { spin_ticket_lock_acquire(&l->ticket); }
+static void ticket_release(bench_locks_t *l, spin_mcs_node_t *n) { spin_ticket_lock_release(&l->ticket); }
+static void mcs_acquire(bench_locks_t *l, spin_mcs_node_t *n) { spin_mcs_lock_acquire(&l->mcs, n); }
+static void mcs_release(bench_locks_t *l, spin_mcs_node_t *n) { spin_mcs_lock_release(&l->mcs, n); }
+static void adaptive_acquire(bench_locks_t *l, spin_mcs_node_t *n) { spin_adaptive_lock_acquire(&l->adaptive); }
+static void adaptive_release(bench_locks_t *l, spin_mcs_node_t *n) { spin_adaptive_lock_release(&l->adaptive); }
+static void rwlock_acquire(bench_locks_t *l, spin_mcs_node_t *n) { spin_rwlock_write_acquire(&l->rwlock); }
+static void rwlock_release(bench_locks_t *l, spin_mcs_node_t *n) { spin_rwlock_write_release(&l->rwlock); }
+static void seqlock_acquire(bench_locks_t *l, spin_mcs_node_t *n) { spin_seqlock_write_acquire(&l->seqlock); }
+static void seqlock_release(bench_locks_t *l, spin_mcs_node_t *n) { spin_seqlock_write_release(&l->seqlock); }
+
+static const lock_type_t g_lock_types[] = {
+    { "spin",     spin_acquire,     spin_release     },
+    { "ticket",   ticket_acquire,   ticket_release   },
+    { "mcs",      mcs_acquire,      mcs_release      },
+    { "adaptive", adaptive_acquire, adaptive_release },
+    { "rwlock",   rwlock_acquire,   rwlock_release   },
+    { "seqlock",  seqlock_acquire,  seqlock_release  },
+};
+
+#define LOCK_TYPE_COUNT (sizeof(g_lock_types) / sizeof(g_lock_types[0]))
+
+/* ------------------------------------------------------------------------- */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}   /* now_ns() */
+
+/* ------------------------------------------------------------------------- */
+static void work(unsigned count) {
+    volatile unsigned sink = 0;
+    unsigned i;
+    for (i = 0; i < count; ++i) {
+        sink = i;
+    }
+    (void) sink;
+}   /* work() */
+
+/* ------------------------------------------------------------------------- */
+static void *bench_thread(void *arg) {
+    bench_thread_t *self = (bench_thread_t *) arg;
+    bench_t *bench = self->bench;
+    const lock_type_t *lock_type = bench->lock_type;
+    spin_mcs_node_t node;
+    uint64_t ops = 0;
+
+    while (!__atomic_load_n(&bench->go, __ATOMIC_ACQUIRE)) {
+        spin_lock_pause();
+    }
+    while (!__atomic_load_n(&bench->stop, __ATOMIC_RELAXED)) {
+        uint64_t start = now_ns();
+        lock_type->acquire(&bench->locks, &node);
+        self->latency_ns[ops & (LATENCY_SAMPLES - 1)] = (uint32_t) (now_ns() - start);
+        bench->shared++;
+        work(bench->cs_work);
+        lock_type->release(&bench->locks, &node);
+        ++ops;
+        work(bench->think_work);
+    }
+    self->ops = ops;
+    return NULL;
+}   /* bench_thread() */
+
+/* ------------------------------------------------------------------------- */
+static int compare_uint32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a;
+    uint32_t y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}   /* compare_uint32() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Run @p lock_type on @p thread_count threads for @p duration_ms and print
+ * a CSV row of results.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int bench_run(bench_t *bench, const lock_type_t *lock_type, int thread_count, unsigned duration_ms) {
+    static const bench_locks_t locks_init = {
+        SPIN_LOCK_INIT_UNLOCKED, SPIN_TICKET_LOCK_INIT_UNLOCKED, SPIN_MCS_LOCK_INIT_UNLOCKED,
+        SPIN_ADAPTIVE_LOCK_INIT_UNLOCKED, SPIN_RWLOCK_INIT_UNLOCKED, SPIN_SEQLOCK_INIT_UNLOCKED,
+    };
+    uint32_t *latencies = NULL;
+    size_t latency_count = 0;
+    uint64_t total_ops = 0;
+    uint64_t min_ops = UINT64_MAX;
+    uint64_t max_ops = 0;
+    uint64_t start = 0;
+    uint64_t elapsed = 0;
+    struct timespec ts;
+    int started = 0;
+    int i = 0;
+
+    bench->lock_type = lock_type;
+    bench->locks = locks_init;
+    bench->shared = 0;
+    bench->go = 0;
+    bench->stop = 0;
+    memset(bench->threads, 0, thread_count * sizeof(bench->threads[0]));
+
+    for (started = 0; started < thread_count; ++started) {
+        bench->threads[started].bench = bench;
+        if (0 != pthread_create(&bench->threads[started].thread, NULL, bench_thread, &bench->threads[started])) {
+            fprintf(stderr, "%s: could not create thread %d\n", g_program_name, started);
+            break;
+        }
+    }
+    start = now_ns();
+    __atomic_store_n(&bench->go, 1, __ATOMIC_RELEASE);
+    ts.tv_sec = duration_ms / 1000;
+    ts.tv_nsec = (duration_ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+    __atomic_store_n(&bench->stop, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < started; ++i) {
+        pthread_join(bench->threads[i].thread, NULL);
+    }
+    elapsed = now_ns() - start;
+    if (started < thread_count) {
+        return 0;
+    }
+
+    latencies = malloc(thread_count * sizeof(uint32_t) * LATENCY_SAMPLES);
+    if (NULL == latencies) {
+        return 0;
+    }
+    for (i = 0; i < thread_count; ++i) {
+        uint64_t ops = bench->threads[i].ops;
+        size_t samples = (ops < LATENCY_SAMPLES) ? ops : LATENCY_SAMPLES;
+        total_ops += ops;
+        min_ops = (ops < min_ops) ? ops : min_ops;
+        max_ops = (ops > max_ops) ? ops : max_ops;
+        memcpy(&latencies[latency_count], bench->threads[i].latency_ns, samples * sizeof(uint32_t));
+        latency_count += samples;
+    }
+    qsort(latencies, latency_count, sizeof(uint32_t), compare_uint32);
+    printf("%s,%d,%u,%u,%llu,%.0f,%llu,%llu,%u,%u\n",
+           lock_type->name, thread_count, bench->cs_work, bench->think_work,
+           (unsigned long long) total_ops, total_ops * 1e9 / elapsed,
+           (unsigned long long) min_ops, (unsigned long long) max_ops,
+           (latency_count > 0) ? latencies[latency_count / 2] : 0,
+           (latency_count > 0) ? latencies[latency_count * 99 / 100] : 0);
+    fflush(stdout);
+    free(latencies);
+    return (bench->shared == total_ops);
+}   /* bench_run() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [lock-name...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "  -t <threads>                  Maximum thread count [number of CPUs, up to %d].\n", MAX_THREADS);
+    fprintf(f, "  -c <count>                    Work loop count inside the lock [50].\n");
+    fprintf(f, "  -w <count>                    Work loop count outside the lock [200].\n");
+    fprintf(f, "  -d <ms>                       Duration of each run in milliseconds [200].\n");
+    fprintf(f, "\n");
+    fprintf(f, "  Locks are: spin ticket mcs adaptive rwlock seqlock (default all).\n");
+    fprintf(f, "\n");
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    static bench_t bench;
+    int selected[LOCK_TYPE_COUNT];
+    int any_selected = 0;
+    long max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned duration_ms = 200;
+    int ok = 1;
+    int i = 0;
+    size_t l = 0;
+
+    g_program_name = argv[0];
+    memset(selected, 0, sizeof(selected));
+    if (max_threads < 1) {
+        max_threads = 1;
+    } else if (max_threads > MAX_THREADS) {
+        max_threads = MAX_THREADS;  /* Only an explicit -t beyond it is an error. */
+    }
+    bench.cs_work = 50;
+    bench.think_work = 200;
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-t"))) {
+            max_threads = atol(argv[++i]);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-c"))) {
+            bench.cs_work = (unsigned) atol(argv[++i]);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-w"))) {
+            bench.think_work = (unsigned) atol(argv[++i]);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-d"))) {
+            duration_ms = (unsigned) atol(argv[++i]);
+        } else {
+            for (l = 0; l < LOCK_TYPE_COUNT; ++l) {
+                if (0 == strcmp(argv[i], g_lock_types[l].name)) {
+                    selected[l] = 1;
+                    any_selected = 1;
+                    break;
+                }
+            }
+            if (LOCK_TYPE_COUNT == l) {
+                fprintf(stderr, "%s: unknown option or lock '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+    if ((max_threads < 1) || (max_threads > MAX_THREADS)) {
+        fprintf(stderr, "%s: thread count must be 1..%d\n", g_program_name, MAX_THREADS);
+        exit(1);
+    }
+    bench.threads = calloc(max_threads, sizeof(bench_thread_t));
+    if (NULL == bench.threads) {
+        fprintf(stderr, "%s: out of memory\n", g_program_name);
+        exit(1);
+    }
+
+    printf("lock,threads,cs_work,think_work,ops,ops_per_sec,min_thread_ops,max_thread_ops,"
+           "p50_acquire_ns,p99_acquire_ns\n");
+    for (l = 0; l < LOCK_TYPE_COUNT; ++l) {
+        if (any_selected && !selected[l]) {
+            continue;
+        }
+        for (i = 1; i <= max_threads; ++i) {
+            if (!bench_run(&bench, &g_lock_types[l], i, duration_ms)) {
+                fprintf(stderr, "%s: %s with %d threads failed\n", g_program_name, g_lock_types[l].name, i);
+                ok = 0;
+            }
+        }
+    }
+    free(bench.threads);
+    return ok ? 0 : 1;
+}   /* main() */
@@ -7,81 +7,99 @@
 
 #include <stdlib.h>
 
+#include "mallmock.h"
 #include "spin_lock.h"
 
-/* @todo Just use atomic counters and bools. */
+/*
+ * The configuration is written rarely but read on every allocation, so it
+ * sits behind a sequence lock: while no failure is set up, allocating
+ * threads never write to it. While one is, each allocation counts itself
+ * under the write side, so that a concurrent reconfiguration can't slip in
+ * between checking the call count and bumping it.
+ */
 static size_t g_mallmock_any_alloc_calls = 0;
 static size_t g_mallmock_any_alloc_prefail_successes = 0;
 static void *g_mallmock_fail_return = NULL;
-static spin_lock_t g_mallmock_lock = SPIN_LOCK_INIT_UNLOCKED;
+static spin_seqlock_t g_mallmock_lock = SPIN_SEQLOCK_INIT_UNLOCKED;
 static int g_hook_active = 0;
+#if defined(SPIN_LOCK_STATS)
+static uint64_t g_mallmock_reads = 0;          /**< Read sections run by allocations. */
+static uint64_t g_mallmock_read_retries = 0;   /**< Those that raced a writer and ran again. */
+#endif
 
 extern void *__libc_malloc(size_t);
 extern void *__libc_calloc(size_t, size_t);
 extern void *__libc_realloc(void *, size_t);
 
 /* ------------------------------------------------------------------------- */
-void *malloc(size_t size) {
-    void *rval = NULL;
-    int call_original = 1;
-    spin_lock_acquire(&g_mallmock_lock);
-    if (g_hook_active) {
-        if (g_mallmock_any_alloc_calls++ == g_mallmock_any_alloc_prefail_successes) {
-            call_original = 0;
+/**
+ * Count an allocation call against the current configuration.
+ *
+ * @return 1 if the call should go through to libc, or 0 if it should fail
+ * by returning @p *rval.
+ */
+static int mallmock_call_original(void **rval) {
+    uint32_t sequence;
+    int hook_active = 0;
+    int ok = 1;
+
+    for (;;) {
+        sequence = spin_seqlock_read_begin(&g_mallmock_lock);
+        hook_active = __atomic_load_n(&g_hook_active, __ATOMIC_RELAXED);
+#if defined(SPIN_LOCK_STATS)
+        __atomic_fetch_add(&g_mallmock_reads, 1, __ATOMIC_RELAXED);
+#endif
+        if (!spin_seqlock_read_retry(&g_mallmock_lock, sequence)) {
+            break;
         }
+#if defined(SPIN_LOCK_STATS)
+        __atomic_fetch_add(&g_mallmock_read_retries, 1, __ATOMIC_RELAXED);
+#endif
     }
-    if (call_original) {
+
+    if (hook_active) {
+        spin_seqlock_write_acquire(&g_mallmock_lock);
+        if (g_hook_active && (g_mallmock_any_alloc_calls++ == g_mallmock_any_alloc_prefail_successes)) {
+            *rval = g_mallmock_fail_return;
+            ok = 0;
+        }
+        spin_seqlock_write_release(&g_mallmock_lock);
+    }
+    return ok;
+}   /* mallmock_call_original() */
+
+/* ------------------------------------------------------------------------- */
+void *malloc(size_t size) {
+    void *rval = NULL;
+    if (mallmock_call_original(&rval)) {
         rval = __libc_malloc(size);
-    } else {
-        rval = g_mallmock_fail_return;
     }
-    spin_lock_release(&g_mallmock_lock);
     return rval;
 }   /* malloc() */
 
 /* ------------------------------------------------------------------------- */
 void *calloc(size_t size, size_t nelements) {
     void *rval = NULL;
-    int call_original = 1;
-    spin_lock_acquire(&g_mallmock_lock);
-    if (g_hook_active) {
-        if (g_mallmock_any_alloc_calls++ == g_mallmock_any_alloc_prefail_successes) {
-            call_original = 0;
-        }
-    }
-    if (call_original) {
+    if (mallmock_call_original(&rval)) {
         rval = __libc_calloc(size, nelements);
-    } else {
-        rval = g_mallmock_fail_return;
     }
-    spin_lock_release(&g_mallmock_lock);
     return rval;
 }   /* calloc() */
 
 /* ------------------------------------------------------------------------- */
 void *realloc(void *ptr, size_t new_size) {
     void *rval = NULL;
-    int call_original = 1;
-    spin_lock_acquire(&g_mallmock_lock);
-    if (g_hook_active) {
-        if (g_mallmock_any_alloc_calls++ == g_mallmock_any_alloc_prefail_successes) {
-            call_original = 0;
-        }
-    }
-    if (call_original) {
+    if (mallmock_call_original(&rval)) {
         rval = __libc_realloc(ptr, new_size);
-    } else {
-        rval = g_mallmock_fail_return;
     }
-    spin_lock_release(&g_mallmock_lock);
     return rval;
 }   /* realloc() */
 
 /* ------------------------------------------------------------------------- */
 static void mallmock_unhook(void) {
-    spin_lock_acquire(&g_mallmock_lock);
-    g_hook_active = 0;
-    spin_lock_release(&g_mallmock_lock);
+    spin_seqlock_write_acquire(&g_mallmock_lock);
+    __atomic_store_n(&g_hook_active, 0, __ATOMIC_RELAXED);
+    spin_seqlock_write_release(&g_mallmock_lock);
 }   /* mallmock_unhook() */
 
 /* ------------------------------------------------------------------------- */
@@ -91,10 +109,23 @@ void mallmock_reset(void) {
 
 /* ------------------------------------------------------------------------- */
 void mallmock_set_any_alloc_return(void *rval, size_t successful_returns_first) {
-    spin_lock_acquire(&g_mallmock_lock);
-    g_mallmock_any_alloc_calls = 0;
-    g_mallmock_any_alloc_prefail_successes = successful_returns_first;
-    g_mallmock_fail_return = rval;
-    g_hook_active = 1;
-    spin_lock_release(&g_mallmock_lock);
+    spin_seqlock_write_acquire(&g_mallmock_lock);
+    __atomic_store_n(&g_mallmock_any_alloc_calls, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_mallmock_any_alloc_prefail_successes, successful_returns_first, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_mallmock_fail_return, rval, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_hook_active, 1, __ATOMIC_RELAXED);
+    spin_seqlock_write_release(&g_mallmock_lock);
 }   /* mallmock_set_any_alloc_return() */
+
+#if defined(SPIN_LOCK_STATS)
+/* ------------------------------------------------------------------------- */
+void mallmock_dump_lock_stats(FILE *f) {
+    uint64_t reads = __atomic_load_n(&g_mallmock_reads, __ATOMIC_RELAXED);
+    uint64_t retries = __atomic_load_n(&g_mallmock_read_retries, __ATOMIC_RELAXED);
+
+    spin_lock_dump_stats(f, "g_mallmock_lock", &g_mallmock_lock.lock);
+    fprintf(f, "g_mallmock_lock: %llu reads, %llu retried (%.1f%%)\n",
+            (unsigned long long) reads, (unsigned long long) retries,
+            (0 == reads) ? 0.0 : (100.0 * retries / reads));
+}   /* mallmock_dump_lock_stats() */
+#endif
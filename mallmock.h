@@ -10,6 +10,10 @@ extern "C" {
 
 #include <stddef.h>
 
+#if defined(SPIN_LOCK_STATS)
+#include <stdio.h>
+#endif
+
 /**
  * Reset - always call through to libc's allocation functions.
  */
@@ -29,6 +33,18 @@ void mallmock_set_malloc_return(void *rval, size_t successful_returns_first);
  */
 void mallmock_set_any_alloc_return(void *rval, size_t successful_returns_first);
 
+#if defined(SPIN_LOCK_STATS)
+/**
+ * Print contention statistics for mallmock's configuration lock to @p f.
+ * The lock is a sequence lock, so its spin lock statistics cover only the
+ * writers: configuration changes, and allocations counted while a failure
+ * is set up. Every other allocation only reads, and shows up as a read,
+ * or a retried read if it raced a writer. Only available when built with
+ * `SPIN_LOCK_STATS` (see spin_lock.h).
+ */
+void mallmock_dump_lock_stats(FILE *f);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,178 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Benchmark for the newline search kernels in find_newline.c.
+ *
+ * Each kernel finds every newline in a generated corpus, the way the line
+ * splitter in read_file.c does. The original byte loop from read_file.c and
+ * memchr() are timed alongside. Results are printed to stdout as CSV, one
+ * row per kernel and corpus, in GB per second:
+ *
+ * - short, lines of 1 to 80 bytes, like a typical log.
+ * - long, lines of 500 to 3000 bytes.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "find_newline.h"
+
+const char *g_program_name = "newline_bench"; /**< This program name; overwritten by argv[0]. */
+
+typedef struct corpus_s {
+    const char *name;
+    size_t min_line;
+    size_t max_line;
+} corpus_t;
+
+static const corpus_t g_corpora[] = {
+    { "short", 1,   80 },
+    { "long",  500, 3000 },
+};
+
+/* ------------------------------------------------------------------------- */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}   /* now_ns() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * The loop that read_file_new() used before find_newline().
+ */
+static const char *find_newline_loop(const char *p, const char *end) {
+    size_t i = 0;
+    for (i = 0; i < (size_t) (end - p); ++i) {
+        if ('\n' == p[i]) {
+            return &p[i];
+        }
+    }
+    return NULL;
+}   /* find_newline_loop() */
+
+/* ------------------------------------------------------------------------- */
+static const char *find_newline_memchr(const char *p, const char *end) {
+    return memchr(p, '\n', end - p);
+}   /* find_newline_memchr() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Fill @p buf with @p size bytes of lines whose lengths, newline included,
+ * are between @p corpus's limits.
+ *
+ * @return the number of newlines.
+ */
+static size_t fill_corpus(char *buf, size_t size, const corpus_t *corpus) {
+    size_t newlines = 0;
+    size_t i = 0;
+
+    while (i < size) {
+        size_t length = corpus->min_line + (size_t) rand() % (corpus->max_line - corpus->min_line + 1);
+        size_t j = 0;
+        for (j = 0; (j + 1 < length) && (i < size); ++j) {
+            buf[i++] = ' ' + (char) (rand() % 95);
+        }
+        if (i < size) {
+            buf[i++] = '\n';
+            newlines++;
+        }
+    }
+    return newlines;
+}   /* fill_corpus() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Time @p repeat passes of @p find over @p buf and print a CSV row.
+ *
+ * @return 1 if every pass found @p expected newlines, 0 otherwise.
+ */
+static int time_kernel(const char *name, find_newline_func_t find, const char *corpus_name,
+                       const char *buf, size_t size, int repeat, size_t expected) {
+    const char *end = buf + size;
+    uint64_t start = now_ns();
+    uint64_t elapsed = 0;
+    int ok = 1;
+    int i = 0;
+
+    for (i = 0; i < repeat; ++i) {
+        const char *p = buf - 1;
+        size_t newlines = 0;
+        while (NULL != (p = find(p + 1, end))) {
+            newlines++;
+        }
+        ok = ok && (newlines == expected);
+    }
+    elapsed = now_ns() - start;
+    printf("%s,%s,%zu,%.2f\n", name, corpus_name, size, (double) size * repeat / (double) elapsed);
+    fflush(stdout);
+    return ok;
+}   /* time_kernel() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "  -r <repeat>                   Number of timed passes per kernel [10].\n");
+    fprintf(f, "  -s <bytes>                    Size of each corpus [16777216].\n");
+    fprintf(f, "\n");
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    const find_newline_kernel_t *kernel = NULL;
+    size_t size = 16 << 20;
+    int repeat = 10;
+    char *buf = NULL;
+    size_t c = 0;
+    int ok = 1;
+    int i = 0;
+
+    g_program_name = argv[0];
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-r"))) {
+            repeat = atoi(argv[++i]);
+        } else if ((i + 1 < argc) && (0 == strcmp(argv[i], "-s"))) {
+            size = (size_t) strtoull(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "%s: unknown option '%s'\n", g_program_name, argv[i]);
+            fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+            exit(1);
+        }
+    }
+    if (repeat < 1) {
+        repeat = 1;
+    }
+    buf = malloc(size + 1);
+    if (NULL == buf) {
+        fprintf(stderr, "%s: no memory for %zu bytes\n", g_program_name, size);
+        exit(1);
+    }
+
+    printf("kernel,corpus,bytes,gb_per_sec\n");
+    for (c = 0; c < sizeof(g_corpora) / sizeof(g_corpora[0]); ++c) {
+        size_t newlines = fill_corpus(buf, size, &g_corpora[c]);
+        ok = time_kernel("loop", find_newline_loop, g_corpora[c].name, buf, size, repeat, newlines) && ok;
+        ok = time_kernel("memchr", find_newline_memchr, g_corpora[c].name, buf, size, repeat, newlines) && ok;
+        for (kernel = g_find_newline_kernels; NULL != kernel->name; ++kernel) {
+            if ((NULL != kernel->find) && kernel->supported()) {
+                ok = time_kernel(kernel->name, kernel->find, g_corpora[c].name, buf, size, repeat, newlines) && ok;
+            }
+        }
+        ok = time_kernel("find_newline", find_newline, g_corpora[c].name, buf, size, repeat, newlines) && ok;
+    }
+    free(buf);
+    if (!ok) {
+        fprintf(stderr, "%s: a kernel miscounted newlines\n", g_program_name);
+    }
+    return ok ? 0 : 1;
+}   /* main() */
@@ -3,12 +3,23 @@
 
 #include <assert.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include "find_newline.h"
 #include "link_list.h"
 #include "read_file.h"
+#include "read_file_sidecar.h"
+#include "read_file_source.h"
+
+/**
+ * How many lines ahead to prefetch when walking the line list.
+ */
+#define READ_FILE_PREFETCH_DISTANCE 4
 
 /**
  * A single line consists of a link for use in a linked list and a pointer to
@@ -16,25 +27,148 @@
  */
 typedef struct line_item_s {
     link_t link;  /**< Link for placing in main list. */
+    size_t size;  /**< Bytes in line, not counting the terminator. */
     char line[0]; /**< NUL-terminated characters for this line. */
 } line_item_t;
 
+/**
+ * Initial sizes of the contiguous line storage, doubled as needed.
+ */
+#define READ_FILE_INITIAL_DATA_SIZE     0x1000
+#define READ_FILE_INITIAL_LINE_OFFSETS  0x100
+
+/**
+ * How the lines of a read_file_t are stored.
+ */
+typedef enum read_file_storage_e {
+    READ_FILE_STORAGE_LIST,        /**< One line_item_t per line, in line_list. */
+    READ_FILE_STORAGE_CONTIGUOUS,  /**< All lines in data, found by line_offsets. */
+    READ_FILE_STORAGE_MMAP,        /**< The file mapped at map, lines found by line_offsets. */
+} read_file_storage_t;
+
 /**
  * A read-file object consists of a 
  */
 struct read_file_s {
     char *filename;    /**< Name of file that was opened; on the heap. */
     size_t line_count; /**< Number of lines read from file. */
+    read_file_storage_t storage; /**< Which of the fields below hold the lines. */
     list_t line_list;  /**< Linked list of lines, each on the heap. */
+    const char **line_index; /**< Lines by number; built on first use, or NULL. */
+    char *data;        /**< NUL-terminated lines, one after the other. */
+    size_t data_size;  /**< Bytes used in data. */
+    size_t data_capacity;     /**< Bytes allocated for data. */
+    size_t *line_offsets;     /**< Start of each line in data or map, plus the end of the last. */
+    size_t offsets_capacity;  /**< Entries allocated for line_offsets. */
+    const char *map;   /**< Mapping of the whole file, or NULL. */
+    size_t map_size;   /**< Size of map in bytes. */
+    read_file_sidecar_t *sidecar;   /**< Index of the mapped lines instead of line_offsets, or NULL. */
+    unsigned int flags;       /**< READ_FILE_... flags it was loaded with. */
+    dev_t dev;         /**< Device of the file when loaded. */
+    ino_t ino;         /**< Inode of the file when loaded. */
+    size_t consumed;   /**< Bytes of the file covered by the lines. */
+    int partial;       /**< Whether the last line has no newline. */
+    int in_arena;      /**< Whether it all belongs to a read_file_batch_t. */
+    read_file_compression_t compression;   /**< How the file is compressed, found when it was loaded. */
+};
+
+/**
+ * Smallest piece of a file that read_file_new_parallel() gives a thread.
+ */
+#define READ_FILE_PARALLEL_MIN_RANGE    0x10000
+
+/**
+ * A byte range of a mapped file, split by one thread of
+ * read_file_new_parallel().
+ */
+typedef struct read_file_range_s {
+    read_file_t *f;     /**< Where the lines go, in the second pass. */
+    const char *map;    /**< The whole file. */
+    size_t start;       /**< Offset of this range in map. */
+    size_t end;         /**< Offset of the end of this range in map. */
+    size_t newlines;    /**< Newlines in this range, from the first pass. */
+    size_t first_line;  /**< Newlines before this range. */
+    int copy;           /**< 0 to count newlines, 1 to copy lines to f. */
+    pthread_t thread;
+} read_file_range_t;
+
+/**
+ * Smallest block of memory that a batch worker's arena allocates.
+ */
+#define READ_FILE_ARENA_CHUNK_SIZE      0x100000
+
+/**
+ * Alignment of allocations from an arena; enough for any read_file_t field.
+ */
+#define READ_FILE_ARENA_ALIGN           (2 * sizeof(size_t))
+
+/**
+ * One block of memory in an arena. Allocations are carved from the end of
+ * the last chunk in the arena's list.
+ */
+typedef struct read_file_chunk_s {
+    link_t link;       /**< Link in the arena's list of chunks. */
+    size_t size;       /**< Bytes in data. */
+    size_t used;       /**< Bytes of data handed out. */
+    char data[0] __attribute__((aligned(16)));  /**< The memory. */
+} read_file_chunk_t;
+
+/**
+ * All the files of a batch, and all the memory they use.
+ */
+struct read_file_batch_s {
+    size_t count;      /**< Number of files in the batch. */
+    read_file_t **files;      /**< Each file, or NULL if it couldn't be loaded. */
+    list_t chunks;     /**< Arena chunks of all the workers. */
+};
+
+/**
+ * One thread loading files for read_file_load_batch(), into its own arena
+ * so that no locking is needed.
+ */
+typedef struct read_file_worker_s {
+    read_file_batch_t *batch; /**< Where the files go. */
+    const char *const *paths; /**< Names of all the files. */
+    size_t *next;      /**< Index of the next file to load, shared by all workers. */
+    list_t chunks;     /**< This worker's arena. */
+    char *scratch;     /**< Buffer for a file's raw contents. */
+    size_t scratch_size;      /**< Bytes allocated for scratch. */
+    pthread_t thread;
+} read_file_worker_t;
+
+/**
+ * Buffer size for cursors from read_file_cursor_open().
+ */
+#define READ_FILE_CURSOR_BUFFER_SIZE    0x10000
+
+/**
+ * A cursor reads a file into a fixed buffer and hands out one line at a
+ * time. The byte after the last line handed out is replaced by a NUL, and
+ * put back on the next call.
+ */
+struct read_file_cursor_s {
+    int fd;            /**< File to close with the cursor, or -1. */
+    read_file_source_t *source; /**< Where the bytes come from. */
+    read_file_fd_source_t fd_source; /**< Plain read() source, if that's used. */
+    char *buf;         /**< Buffer of capacity bytes plus one for a NUL. */
+    char *heap;        /**< Grown buffer that replaced the first one, or NULL. */
+    size_t capacity;   /**< Usable bytes in buf. */
+    size_t start;      /**< Start of the next line in buf. */
+    size_t scan;       /**< Where to resume searching for a newline. */
+    size_t end;        /**< End of the bytes read into buf. */
+    char saved;        /**< Byte that the NUL at buf[start] replaced. */
+    int eof;           /**< Whether read() has returned 0. */
+    int error;         /**< Whether read() has failed, or a whole line didn't fit. */
+    int whole;         /**< Whether a line too long for the buffer is an error rather than split. */
 };
 
 /* ------------------------------------------------------------------------- */
 /**
- * Add a line to the read_file_t @p f.
+ * Add a line to the read_file_t @p f, as a line item on its list.
  *
  * @return 1 on success, 0 on failure.
  */
-static int read_file_add_line(read_file_t *f, const char *line, size_t size) {
+static int read_file_add_line_item(read_file_t *f, const char *line, size_t size) {
     line_item_t *li = NULL;
 
     assert(NULL != f);
@@ -47,18 +181,529 @@ static int read_file_add_line(read_file_t *f, const char *line, size_t size) {
         return 0;
     }
     memcpy(li->line, line, size);
+    li->size = size;
     list_insert_prev(&f->line_list, &li->link);
     f->line_count++;
     return 1;
+}   /* read_file_add_line_item() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Make sure there is room in the line offsets of @p f for one more line.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_reserve_line_offset(read_file_t *f) {
+    if (f->line_count + 2 > f->offsets_capacity) {
+        size_t capacity = (0 == f->offsets_capacity) ? READ_FILE_INITIAL_LINE_OFFSETS : 2 * f->offsets_capacity;
+        size_t *offsets = realloc(f->line_offsets, capacity * sizeof(offsets[0]));
+        if (NULL == offsets) {
+            return 0;
+        }
+        if (NULL == f->line_offsets) {
+            offsets[0] = 0;
+        }
+        f->line_offsets = offsets;
+        f->offsets_capacity = capacity;
+    }
+    return 1;
+}   /* read_file_reserve_line_offset() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Add a line to the read_file_t @p f, at the end of its contiguous data.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_add_line_contiguous(read_file_t *f, const char *line, size_t size) {
+    assert(NULL != f);
+    assert(NULL != line);
+    assert(size > 0);
+
+    if (!read_file_reserve_line_offset(f)) {
+        return 0;
+    }
+    if (f->data_size + size + 1 > f->data_capacity) {
+        size_t capacity = (0 == f->data_capacity) ? READ_FILE_INITIAL_DATA_SIZE : f->data_capacity;
+        char *data = NULL;
+        while (f->data_size + size + 1 > capacity) {
+            capacity *= 2;
+        }
+        data = realloc(f->data, capacity);
+        if (NULL == data) {
+            return 0;
+        }
+        f->data = data;
+        f->data_capacity = capacity;
+    }
+    memcpy(&f->data[f->data_size], line, size);
+    f->data[f->data_size + size] = 0;
+    f->data_size += size + 1;
+    f->line_offsets[++f->line_count] = f->data_size;
+    return 1;
+}   /* read_file_add_line_contiguous() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Add a line to the read_file_t @p f.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_add_line(read_file_t *f, const char *line, size_t size) {
+    int ok = 0;
+    if (READ_FILE_STORAGE_CONTIGUOUS == f->storage) {
+        ok = read_file_add_line_contiguous(f, line, size);
+    } else {
+        ok = read_file_add_line_item(f, line, size);
+    }
+    if (ok) {
+        f->consumed += size;
+        f->partial = ('\n' != line[size - 1]);
+    }
+    return ok;
 }   /* read_file_add_line() */
 
+/* ------------------------------------------------------------------------- */
+/**
+ * Remove the last line from the read_file_t @p f, which must have one.
+ */
+static void read_file_remove_last_line(read_file_t *f) {
+    assert(f->line_count > 0);
+    if (READ_FILE_STORAGE_LIST == f->storage) {
+        line_item_t *li = STRUCT_CONTAINING_LINK(list_remove_prev(&f->line_list), line_item_t, link);
+        f->consumed -= li->size;
+        free(li);
+    } else {
+        f->consumed -= f->line_offsets[f->line_count] - f->line_offsets[f->line_count - 1];
+        if (READ_FILE_STORAGE_CONTIGUOUS == f->storage) {
+            f->consumed++;      /* For the NUL. */
+            f->data_size = f->line_offsets[f->line_count - 1];
+        }
+    }
+    f->line_count--;
+    f->partial = 0;
+}   /* read_file_remove_last_line() */
+
 /* ------------------------------------------------------------------------- */
 read_file_t *read_file_new(const char *filename) {
+    return read_file_new_with_flags(filename, 0);
+}   /* read_file_new() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Set up @p c to read lines from @p source into @p buf, which must have
+ * room for @p buf_size bytes. The source is set later if @p source is
+ * NULL.
+ */
+static void read_file_cursor_init(read_file_cursor_t *c, read_file_source_t *source, char *buf, size_t buf_size) {
+    assert(NULL != c);
+    assert(buf_size > 1);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+    c->source = source;
+    c->buf = buf;
+    c->capacity = buf_size - 1;
+    c->buf[0] = 0;
+}   /* read_file_cursor_init() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Move the partial line in the buffer of @p c to the start of a new buffer
+ * twice the size.
+ *
+ * @return 1 on success, 0 if the new buffer can't be allocated.
+ */
+static int read_file_cursor_grow(read_file_cursor_t *c) {
+    size_t capacity = 2 * c->capacity;
+    char *heap = malloc(capacity + 1);
+
+    if (NULL == heap) {
+        return 0;
+    }
+    memcpy(heap, &c->buf[c->start], c->end - c->start);
+    free(c->heap);
+    c->heap = heap;
+    c->buf = heap;
+    c->capacity = capacity;
+    c->end -= c->start;
+    c->scan = c->end;
+    c->start = 0;
+    return 1;
+}   /* read_file_cursor_grow() */
+
+/* ------------------------------------------------------------------------- */
+const char *read_file_cursor_next(read_file_cursor_t *c, size_t *size) {
+    const char *newline = NULL;
+    size_t line_start = 0;
+    ssize_t bytes_read = 0;
+
+    if (NULL == c) {
+        return NULL;
+    }
+    c->buf[c->start] = c->saved;
+    for (;;) {
+        newline = find_newline(&c->buf[c->scan], &c->buf[c->end]);
+        if (NULL != newline) {
+            line_start = c->start;
+            c->start = newline + 1 - c->buf;
+            break;
+        }
+        c->scan = c->end;
+        if (c->eof || c->error) {
+            if (c->start == c->end) {
+                return NULL;
+            }
+            line_start = c->start;  /* Last line, with no newline. */
+            c->start = c->end;
+            break;
+        }
+
+        /*
+         * Move any partial line to the start of the buffer and read more. A
+         * partial line filling over half the buffer gets a buffer twice the
+         * size, so each read at least matches the bytes moved, and reading
+         * a line of any length takes time linear in its length.
+         */
+        if ((c->end - c->start > c->capacity / 2) && read_file_cursor_grow(c)) {
+            /* Moved. */
+        } else if (c->start > 0) {
+            memmove(&c->buf[0], &c->buf[c->start], c->end - c->start); /* Might overlap, so use memmove(). */
+            c->end -= c->start;
+            c->scan = c->end;
+            c->start = 0;
+        }
+        if ((c->capacity == c->end) && c->whole) {
+            c->error = 1;   /* No newline in a full buffer that can't grow. */
+            c->start = c->end;
+            c->scan = c->end;
+            c->saved = c->buf[c->end];
+            return NULL;
+        } else if (c->capacity == c->end) {
+            /* No newline in a full buffer that can't grow, so hand it all out as a line. */
+            line_start = 0;
+            c->start = c->end;
+            break;
+        }
+        bytes_read = read_file_source_read(c->source, &c->buf[c->end], c->capacity - c->end);
+        if (bytes_read > 0) {
+            c->end += bytes_read;
+        } else if (0 == bytes_read) {
+            c->eof = 1;
+        } else {
+            c->error = 1;
+        }
+    }
+
+    c->scan = c->start;
+    c->saved = c->buf[c->start];
+    c->buf[c->start] = 0;
+    if (NULL != size) {
+        *size = c->start - line_start;
+    }
+    return &c->buf[line_start];
+}   /* read_file_cursor_next() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Start a source of the bytes of @p fd: read in the background if @p flags
+ * has READ_FILE_ASYNC, using @p fd_source otherwise, and decompressed if
+ * @p compression says so.
+ *
+ * @return the source, or NULL on failure.
+ */
+static read_file_source_t *read_file_source_open(int fd, unsigned int flags, read_file_compression_t compression,
+                                                 read_file_fd_source_t *fd_source) {
+    read_file_source_t *source = NULL;
+    read_file_source_t *decompress = NULL;
+
+    if (flags & READ_FILE_ASYNC) {
+        source = read_file_async_source_new(fd);
+    } else {
+        source = read_file_fd_source_init(fd_source, fd);
+    }
+    if ((NULL == source) || (READ_FILE_COMPRESSION_NONE == compression)) {
+        return source;
+    }
+    decompress = read_file_decompress_source_new(source, compression);
+    if (NULL == decompress) {
+        read_file_source_close(source);
+    }
+    return decompress;
+}   /* read_file_source_open() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Read lines from @p fd into @p f, in the background if @p flags has
+ * READ_FILE_ASYNC, and decompressed if `f->compression` says so. That is
+ * known from the start of the file, so bytes appended later are read as
+ * the file is, whatever they look like.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_read_lines(read_file_t *f, int fd, unsigned int flags) {
+    char buf[0x400 + 1];
+    read_file_fd_source_t fd_source;
+    read_file_source_t *source = NULL;
+    read_file_cursor_t cursor;
+    const char *line = NULL;
+    size_t size = 0;
+    int ok = 1;
+
+    source = read_file_source_open(fd, flags, f->compression, &fd_source);
+    if (NULL == source) {
+        return 0;
+    }
+    read_file_cursor_init(&cursor, source, buf, sizeof(buf));
+    cursor.whole = 1;
+    while (ok && (NULL != (line = read_file_cursor_next(&cursor, &size)))) {
+        ok = read_file_add_line(f, line, size);
+    }
+    read_file_source_close(source);
+    free(cursor.heap);
+    return ok && !cursor.error;
+}   /* read_file_read_lines() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Map all of @p fd into @p f and find its lines.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_map_lines(read_file_t *f, int fd) {
+    struct stat st;
+    const char *p = NULL;
+    const char *end = NULL;
+    void *map = NULL;
+
+    /* Keep any old mapping until the new one is made; its lines are still in use. */
+    if ((0 != fstat(fd, &st)) || (st.st_size < 0)) {
+        return 0;
+    }
+    if (0 == st.st_size) {
+        return 1;       /* Can't map nothing; there are no lines anyway. */
+    }
+    map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == map) {
+        return 0;
+    }
+    if (NULL != f->map) {
+        munmap((void *) f->map, f->map_size);
+    }
+    f->map = map;
+    f->map_size = (size_t) st.st_size;
+
+    /* Just hints, so failures don't matter. */
+    (void) madvise(map, f->map_size, MADV_SEQUENTIAL);
+    (void) madvise(map, f->map_size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    (void) madvise(map, f->map_size, MADV_HUGEPAGE);
+#endif
+
+    /* Any lines already found, by read_file_refresh(), are still good. */
+    end = f->map + f->map_size;
+    for (p = f->map + f->consumed; p < end; ) {
+        const char *newline = find_newline(p, end);
+        p = (NULL == newline) ? end : newline + 1;
+        if (!read_file_reserve_line_offset(f)) {
+            return 0;
+        }
+        f->line_offsets[++f->line_count] = p - f->map;
+        f->consumed = p - f->map;
+        f->partial = (NULL == newline);
+    }
+    return 1;
+}   /* read_file_map_lines() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Map all of @p fd into @p f, using its sidecar index if that is valid, or
+ * finding its lines and writing a new sidecar index if not.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_map_indexed(read_file_t *f, int fd) {
+    struct stat st;
+    void *map = NULL;
+
+    if ((0 != fstat(fd, &st)) || (st.st_size <= 0)) {
+        return read_file_map_lines(f, fd);
+    }
+    f->sidecar = read_file_sidecar_open(f->filename, &st);
+    if (NULL == f->sidecar) {
+        if (!read_file_map_lines(f, fd)) {
+            return 0;
+        }
+        if (f->map_size == (size_t) st.st_size) {
+            /* Just a cache, so it doesn't matter if it can't be written. */
+            (void) read_file_sidecar_write(f->filename, &st, f->line_offsets, f->line_count);
+        }
+        return 1;
+    }
+
+    /* Lines will be looked at here and there, not read through. */
+    map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == map) {
+        return 0;
+    }
+    (void) madvise(map, (size_t) st.st_size, MADV_RANDOM);
+    f->map = map;
+    f->map_size = (size_t) st.st_size;
+    f->line_count = read_file_sidecar_line_count(f->sidecar);
+    f->consumed = f->map_size;
+    f->partial = ('\n' != f->map[f->map_size - 1]);
+    return 1;
+}   /* read_file_map_indexed() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Replace the sidecar index of @p f with line offsets, which can grow.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_sidecar_expand(read_file_t *f) {
+    size_t end = 0;
+    size_t n = 0;
+
+    f->line_offsets = malloc((f->line_count + 1) * sizeof(f->line_offsets[0]));
+    if (NULL == f->line_offsets) {
+        return 0;
+    }
+    f->offsets_capacity = f->line_count + 1;
+    for (n = 0; n < f->line_count; ++n) {
+        read_file_sidecar_line(f->sidecar, n, &f->line_offsets[n], &end);
+    }
+    f->line_offsets[f->line_count] = f->map_size;
+    read_file_sidecar_close(f->sidecar);
+    f->sidecar = NULL;
+    return 1;
+}   /* read_file_sidecar_expand() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Remember which file @p fd is, for read_file_refresh().
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_stat(read_file_t *f, int fd) {
+    struct stat st;
+    if (0 != fstat(fd, &st)) {
+        return 0;
+    }
+    f->dev = st.st_dev;
+    f->ino = st.st_ino;
+    return 1;
+}   /* read_file_stat() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Count the newlines in range @p arg or, on the second pass, copy its part
+ * of the file into the contiguous storage of the read_file_t.
+ *
+ * Every line ends up moved along by one byte for each NUL before it, so
+ * the byte at offset i in the file, after first_line newlines, goes to
+ * offset i + first_line in data; lines that cross into the next range need
+ * no special handling.
+ */
+static void *read_file_range_split(void *arg) {
+    read_file_range_t *range = (read_file_range_t *) arg;
+    const char *end = &range->map[range->end];
+    const char *p = &range->map[range->start];
+    const char *newline = NULL;
+
+    if (!range->copy) {
+        for (range->newlines = 0; NULL != (newline = find_newline(p, end)); p = newline + 1) {
+            range->newlines++;
+        }
+    } else {
+        read_file_t *f = range->f;
+        size_t line = range->first_line;
+        for (; NULL != (newline = find_newline(p, end)); p = newline + 1) {
+            size_t line_start = p - range->map;
+            size_t line_end = newline + 1 - range->map;
+            memcpy(&f->data[line_start + line], p, line_end - line_start);
+            f->data[line_end + line] = 0;
+            line++;
+            f->line_offsets[line] = line_end + line;
+        }
+        memcpy(&f->data[p - range->map + line], p, end - p);
+    }
+    return NULL;
+}   /* read_file_range_split() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Run read_file_range_split() on all @p range_count ranges, each on its own
+ * thread except the first, which runs on this one. Ranges whose threads
+ * can't be started also run here.
+ */
+static void read_file_run_ranges(read_file_range_t *ranges, size_t range_count) {
+    size_t i = 0;
+    int *started = NULL;
+
+    started = calloc(range_count, sizeof(started[0]));
+    for (i = 1; (NULL != started) && (i < range_count); ++i) {
+        started[i] = (0 == pthread_create(&ranges[i].thread, NULL, read_file_range_split, &ranges[i]));
+    }
+    for (i = 0; i < range_count; ++i) {
+        if ((NULL == started) || !started[i]) {
+            read_file_range_split(&ranges[i]);
+        }
+    }
+    for (i = 1; (NULL != started) && (i < range_count); ++i) {
+        if (started[i]) {
+            pthread_join(ranges[i].thread, NULL);
+        }
+    }
+    free(started);
+}   /* read_file_run_ranges() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * @return @p thread_count, or the number of CPUs if it is less than 1.
+ */
+static int read_file_thread_count(int thread_count) {
+    if (thread_count < 1) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = (cpus < 1) ? 1 : (int) cpus;
+    }
+    return thread_count;
+}   /* read_file_thread_count() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * @return the number of lines in the @p size bytes at @p p, which hold
+ * @p newlines newlines.
+ */
+static size_t read_file_split_line_count(const char *p, size_t size, size_t newlines) {
+    return newlines + (((0 == size) || ('\n' == p[size - 1])) ? 0 : 1);
+}   /* read_file_split_line_count() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Finish off @p f after its @p size bytes and @p newlines newlines have
+ * been copied by read_file_range_split(), ending any last line that has
+ * no newline.
+ */
+static void read_file_split_finish(read_file_t *f, size_t size, size_t newlines) {
+    if (f->line_count > newlines) {
+        f->data[f->data_size - 1] = 0;
+        f->line_offsets[f->line_count] = f->data_size;
+        f->partial = 1;
+    }
+    f->consumed = size;
+}   /* read_file_split_finish() */
+
+/* ------------------------------------------------------------------------- */
+read_file_t *read_file_new_parallel(const char *filename, int thread_count) {
     read_file_t *f = NULL;
+    read_file_range_t *ranges = NULL;
+    size_t range_count = 0;
+    size_t newlines = 0;
+    struct stat st;
+    void *map = MAP_FAILED;
+    size_t size = 0;
+    size_t i = 0;
     int fd = -1;
-    char buf[0x400];
-    size_t read_index = 0;
-    ssize_t bytes_read = 0;
 
     if (NULL == filename) {
         return NULL;
@@ -67,49 +712,369 @@ read_file_t *read_file_new(const char *filename) {
     if (fd < 0) {
         return NULL;
     }
+    if ((0 != fstat(fd, &st)) || !S_ISREG(st.st_mode) || (0 == st.st_size) ||
+        (READ_FILE_COMPRESSION_NONE != read_file_detect_compression(fd)) ||
+        (MAP_FAILED == (map = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0)))) {
+        close(fd);      /* Nothing to split, no way to map it, or it needs decompressing first. */
+        return read_file_new_with_flags(filename, READ_FILE_CONTIGUOUS);
+    }
+    size = (size_t) st.st_size;
+    (void) madvise(map, size, MADV_WILLNEED);
+
     f = calloc(1, sizeof(struct read_file_s));
     if (NULL == f) {
         goto Error;
     }
     list_init(&f->line_list);
+    f->storage = READ_FILE_STORAGE_CONTIGUOUS;
+    f->flags = READ_FILE_CONTIGUOUS;
+    f->dev = st.st_dev;
+    f->ino = st.st_ino;
     f->filename = strdup(filename);
     if (NULL == f->filename) {
         goto Error;
     }
 
-    while ((bytes_read = read(fd, &buf[read_index], sizeof(buf) - read_index)) > 0) {
-        size_t start = 0;
-        size_t i;
-
-        for (i = read_index; i < read_index + bytes_read; ++i) {
-            if ('\n' == buf[i]) {
-                if (!read_file_add_line(f, &buf[start], i + 1 - start)) {
-                    goto Error;
-                }
-                start = i + 1;
-            }
+    thread_count = read_file_thread_count(thread_count);
+    range_count = (size + READ_FILE_PARALLEL_MIN_RANGE - 1) / READ_FILE_PARALLEL_MIN_RANGE;
+    if (range_count > (size_t) thread_count) {
+        range_count = (size_t) thread_count;
+    }
+    ranges = calloc(range_count, sizeof(ranges[0]));
+    if (NULL == ranges) {
+        goto Error;
+    }
+    for (i = 0; i < range_count; ++i) {
+        ranges[i].f = f;
+        ranges[i].map = map;
+        ranges[i].start = size * i / range_count;
+        ranges[i].end = size * (i + 1) / range_count;
+    }
+
+    /* First count the lines, so everything can be allocated up front. */
+    read_file_run_ranges(ranges, range_count);
+    for (i = 0; i < range_count; ++i) {
+        ranges[i].first_line = newlines;
+        ranges[i].copy = 1;
+        newlines += ranges[i].newlines;
+    }
+    f->line_count = read_file_split_line_count(map, size, newlines);
+    f->data_size = size + f->line_count;
+    f->data_capacity = f->data_size;
+    f->offsets_capacity = f->line_count + 1;
+    f->data = malloc(f->data_capacity);
+    f->line_offsets = malloc(f->offsets_capacity * sizeof(f->line_offsets[0]));
+    if ((NULL == f->data) || (NULL == f->line_offsets)) {
+        goto Error;
+    }
+    f->line_offsets[0] = 0;
+
+    /* Then copy them into place. */
+    read_file_run_ranges(ranges, range_count);
+    read_file_split_finish(f, size, newlines);
+
+    free(ranges);
+    munmap(map, size);
+    close(fd);
+    return f;
+
+Error:
+    free(ranges);
+    read_file_delete(f);
+    munmap(map, size);
+    close(fd);
+    return NULL;
+}   /* read_file_new_parallel() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * @return @p size bytes from the arena in @p chunks, or NULL if a new chunk
+ * is needed and can't be allocated.
+ */
+static void *read_file_arena_alloc(list_t *chunks, size_t size) {
+    read_file_chunk_t *chunk = NULL;
+    void *p = NULL;
+
+    size = (size + READ_FILE_ARENA_ALIGN - 1) & ~(READ_FILE_ARENA_ALIGN - 1);
+    if (!list_empty(chunks)) {
+        chunk = STRUCT_CONTAINING_LINK(chunks->prev, read_file_chunk_t, link);
+    }
+    if ((NULL == chunk) || (chunk->size - chunk->used < size)) {
+        size_t chunk_size = (size > READ_FILE_ARENA_CHUNK_SIZE) ? size : READ_FILE_ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(*chunk) + chunk_size);
+        if (NULL == chunk) {
+            return NULL;
         }
-        if ((sizeof(buf) == i) && (0 == start)) {
-            /*
-             * No newline found in full buffer. Treat it all as a line. It's
-             * just test code! :)
-             */
-            if (!read_file_add_line(f, buf, bytes_read)) {
-                goto Error;
-            }
-            read_index = 0;
-        } else {
-            /* Some leftover. Slide those to the start of the buffer. */
-            size_t bytes_left = read_index + bytes_read - start;
-            memmove(&buf[0], &buf[start], bytes_left); /* Might overlap, so use memmove(). */
-            read_index = bytes_left;
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        list_insert_prev(chunks, &chunk->link);
+    }
+    p = &chunk->data[chunk->used];
+    chunk->used += size;
+    return p;
+}   /* read_file_arena_alloc() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Make sure the scratch buffer of @p w holds at least @p size bytes.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_worker_reserve(read_file_worker_t *w, size_t size) {
+    if (size > w->scratch_size) {
+        size_t scratch_size = (0 == w->scratch_size) ? READ_FILE_INITIAL_DATA_SIZE : w->scratch_size;
+        char *scratch = NULL;
+        while (size > scratch_size) {
+            scratch_size *= 2;
+        }
+        scratch = realloc(w->scratch, scratch_size);
+        if (NULL == scratch) {
+            return 0;
+        }
+        w->scratch = scratch;
+        w->scratch_size = scratch_size;
+    }
+    return 1;
+}   /* read_file_worker_reserve() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Read all of @p fd, whose size is probably @p size, into the scratch
+ * buffer of @p w.
+ *
+ * @return the number of bytes read, or -1 on failure.
+ */
+static ssize_t read_file_worker_slurp(read_file_worker_t *w, int fd, size_t size) {
+    read_file_fd_source_t fd_source;
+    read_file_source_t *source = NULL;
+    ssize_t bytes = 0;
+    size_t used = 0;
+
+    /* One byte over, so that the end is seen without a second pass. */
+    if (!read_file_worker_reserve(w, size + 1)) {
+        return -1;
+    }
+    source = read_file_source_open(fd, 0, read_file_detect_compression(fd), &fd_source);
+    if (NULL == source) {
+        return -1;
+    }
+    for (;;) {
+        if ((used == w->scratch_size) && !read_file_worker_reserve(w, used + 1)) {
+            bytes = -1;
+            break;
+        }
+        bytes = read_file_source_read(source, &w->scratch[used], w->scratch_size - used);
+        if (bytes <= 0) {
+            break;
+        }
+        used += bytes;
+    }
+    read_file_source_close(source);
+    return (bytes < 0) ? -1 : (ssize_t) used;
+}   /* read_file_worker_slurp() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Load @p filename into the arena of @p w, in contiguous storage split by
+ * read_file_range_split().
+ *
+ * @return the loaded file, or NULL on failure.
+ */
+static read_file_t *read_file_worker_load(read_file_worker_t *w, const char *filename) {
+    read_file_range_t range;
+    read_file_t *f = NULL;
+    struct stat st;
+    ssize_t bytes = 0;
+    size_t size = 0;
+    int fd = -1;
+
+    if (NULL == filename) {
+        return NULL;
+    }
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if ((0 != fstat(fd, &st)) || ((bytes = read_file_worker_slurp(w, fd, (size_t) st.st_size)) < 0)) {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    size = (size_t) bytes;
+
+    memset(&range, 0, sizeof(range));
+    range.map = w->scratch;
+    range.end = size;
+    read_file_range_split(&range);
+
+    f = read_file_arena_alloc(&w->chunks, sizeof(*f));
+    if (NULL == f) {
+        return NULL;
+    }
+    memset(f, 0, sizeof(*f));
+    list_init(&f->line_list);
+    f->storage = READ_FILE_STORAGE_CONTIGUOUS;
+    f->flags = READ_FILE_CONTIGUOUS;
+    f->dev = st.st_dev;
+    f->ino = st.st_ino;
+    f->in_arena = 1;
+    f->line_count = read_file_split_line_count(w->scratch, size, range.newlines);
+    f->data_size = size + f->line_count;
+    f->data_capacity = f->data_size;
+    f->offsets_capacity = f->line_count + 1;
+    f->filename = read_file_arena_alloc(&w->chunks, strlen(filename) + 1);
+    f->data = read_file_arena_alloc(&w->chunks, f->data_capacity);
+    f->line_offsets = read_file_arena_alloc(&w->chunks, f->offsets_capacity * sizeof(f->line_offsets[0]));
+    if ((NULL == f->filename) || (NULL == f->data) || (NULL == f->line_offsets)) {
+        return NULL;    /* The arena is freed as a whole. */
+    }
+    strcpy(f->filename, filename);
+    f->line_offsets[0] = 0;
+    range.f = f;
+    range.copy = 1;
+    read_file_range_split(&range);
+    read_file_split_finish(f, size, range.newlines);
+    return f;
+}   /* read_file_worker_load() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Load files for the worker @p arg until there are none left.
+ */
+static void *read_file_worker_run(void *arg) {
+    read_file_worker_t *w = (read_file_worker_t *) arg;
+    size_t i = 0;
+
+    while ((i = __atomic_fetch_add(w->next, 1, __ATOMIC_RELAXED)) < w->batch->count) {
+        w->batch->files[i] = read_file_worker_load(w, w->paths[i]);
+    }
+    return NULL;
+}   /* read_file_worker_run() */
+
+/* ------------------------------------------------------------------------- */
+read_file_batch_t *read_file_load_batch(const char *const *paths, size_t n, int thread_count) {
+    read_file_batch_t *batch = NULL;
+    read_file_worker_t *workers = NULL;
+    size_t worker_count = 0;
+    size_t next = 0;
+    int *started = NULL;
+    size_t i = 0;
+
+    if ((NULL == paths) && (n > 0)) {
+        return NULL;
+    }
+    batch = calloc(1, sizeof(*batch));
+    if (NULL == batch) {
+        return NULL;
+    }
+    list_init(&batch->chunks);
+    batch->count = n;
+    batch->files = calloc(n + 1, sizeof(batch->files[0]));
+    if (NULL == batch->files) {
+        goto Error;
+    }
+
+    worker_count = (size_t) read_file_thread_count(thread_count);
+    if (worker_count > n) {
+        worker_count = (0 == n) ? 1 : n;
+    }
+    workers = calloc(worker_count, sizeof(workers[0]));
+    if (NULL == workers) {
+        goto Error;
+    }
+    for (i = 0; i < worker_count; ++i) {
+        workers[i].batch = batch;
+        workers[i].paths = paths;
+        workers[i].next = &next;
+        list_init(&workers[i].chunks);
+    }
+
+    /* As with read_file_run_ranges(), this thread is a worker too. */
+    started = calloc(worker_count, sizeof(started[0]));
+    for (i = 1; (NULL != started) && (i < worker_count); ++i) {
+        started[i] = (0 == pthread_create(&workers[i].thread, NULL, read_file_worker_run, &workers[i]));
+    }
+    read_file_worker_run(&workers[0]);
+    for (i = 1; (NULL != started) && (i < worker_count); ++i) {
+        if (started[i]) {
+            pthread_join(workers[i].thread, NULL);
         }
     }
+    free(started);
+
+    for (i = 0; i < worker_count; ++i) {
+        list_splice(&batch->chunks, &workers[i].chunks);
+        free(workers[i].scratch);
+    }
+    free(workers);
+    return batch;
+
+Error:
+    read_file_batch_delete(batch);
+    return NULL;
+}   /* read_file_load_batch() */
+
+/* ------------------------------------------------------------------------- */
+size_t read_file_batch_count(read_file_batch_t *batch) {
+    return (NULL == batch) ? 0 : batch->count;
+}   /* read_file_batch_count() */
+
+/* ------------------------------------------------------------------------- */
+read_file_t *read_file_batch_get(read_file_batch_t *batch, size_t i) {
+    return ((NULL == batch) || (i >= batch->count)) ? NULL : batch->files[i];
+}   /* read_file_batch_get() */
+
+/* ------------------------------------------------------------------------- */
+void read_file_batch_delete(read_file_batch_t *batch) {
+    if (NULL != batch) {
+        list_foreach_struct(&batch->chunks, chunk, read_file_chunk_t, link,
+                            link_remove(&chunk->link);
+                            free(chunk));
+        free(batch->files);
+        free(batch);
+    }
+}   /* read_file_batch_delete() */
 
-    if (read_index > 0) {
-        if (!read_file_add_line(f, buf, read_index)) {
+/* ------------------------------------------------------------------------- */
+read_file_t *read_file_new_with_flags(const char *filename, unsigned int flags) {
+    read_file_t *f = NULL;
+    int fd = -1;
+
+    if (NULL == filename) {
+        return NULL;
+    }
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    f = calloc(1, sizeof(struct read_file_s));
+    if (NULL == f) {
+        goto Error;
+    }
+    list_init(&f->line_list);
+    f->flags = flags;
+    if (!read_file_stat(f, fd)) {
+        goto Error;
+    }
+    f->compression = read_file_detect_compression(fd);
+    if ((flags & READ_FILE_MMAP) && (READ_FILE_COMPRESSION_NONE == f->compression)) {
+        f->storage = READ_FILE_STORAGE_MMAP;
+    } else if (flags & (READ_FILE_CONTIGUOUS | READ_FILE_MMAP)) {
+        f->storage = READ_FILE_STORAGE_CONTIGUOUS;
+    } else {
+        f->storage = READ_FILE_STORAGE_LIST;
+    }
+    f->filename = strdup(filename);
+    if (NULL == f->filename) {
+        goto Error;
+    }
+
+    if (READ_FILE_STORAGE_MMAP == f->storage) {
+        if (!((flags & READ_FILE_SIDECAR_INDEX) ? read_file_map_indexed(f, fd) : read_file_map_lines(f, fd))) {
             goto Error;
         }
+    } else if (!read_file_read_lines(f, fd, flags)) {
+        goto Error;
     }
 
     close(fd);
@@ -123,14 +1088,34 @@ Error:
         close(fd);
     }
     return NULL;
-}   /* read_file_new() */
+}   /* read_file_new_with_flags() */
+
+/* ------------------------------------------------------------------------- */
+read_file_t *read_file_new_mmap(const char *filename) {
+    return read_file_new_with_flags(filename, READ_FILE_MMAP);
+}   /* read_file_new_mmap() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Free all the lines of @p f.
+ */
+static void read_file_free_lines(read_file_t *f) {
+    list_foreach_struct_prefetch(&f->line_list, line_item, line_item_t, link, READ_FILE_PREFETCH_DISTANCE,
+                                 link_remove(&line_item->link);
+                                 free(line_item));
+    free(f->line_index);
+    free(f->line_offsets);
+    free(f->data);
+    if (NULL != f->map) {
+        munmap((void *) f->map, f->map_size);
+    }
+    read_file_sidecar_close(f->sidecar);
+}   /* read_file_free_lines() */
 
 /* ------------------------------------------------------------------------- */
 void read_file_delete(read_file_t *f) {
-    if (NULL != f) {
-        list_foreach_struct(&f->line_list, line_item, line_item_t, link,
-                            link_remove(&line_item->link);
-                            free(line_item));
+    if ((NULL != f) && !f->in_arena) {
+        read_file_free_lines(f);
         if (NULL != f->filename) {
             free(f->filename);
             f->filename = NULL;
@@ -163,11 +1148,42 @@ size_t read_file_get_line_count(read_file_t *f) {
     return f->line_count;
 }   /* read_file_get_line_count() */
 
+/* ------------------------------------------------------------------------- */
+/**
+ * Build the line index of @p f, if there is memory for it.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+static int read_file_build_line_index(read_file_t *f) {
+    size_t n = 0;
+
+    assert(NULL != f);
+    f->line_index = malloc((f->line_count + 1) * sizeof(f->line_index[0]));
+    if (NULL == f->line_index) {
+        return 0;
+    }
+    list_foreach_struct(&f->line_list, line_item, line_item_t, link,
+                        f->line_index[n++] = line_item->line);
+    f->line_index[n] = NULL;
+    return 1;
+}   /* read_file_build_line_index() */
+
 /* ------------------------------------------------------------------------- */
 const char *read_file_get_line(read_file_t *f, size_t n) {
     if (NULL == f) {
         return NULL;
     }
+    if (READ_FILE_STORAGE_CONTIGUOUS == f->storage) {
+        return (n < f->line_count) ? &f->data[f->line_offsets[n]] : NULL;
+    }
+    if (READ_FILE_STORAGE_MMAP == f->storage) {
+        return NULL;    /* Mapped lines aren't NUL-terminated. */
+    }
+    if ((NULL != f->line_index) || read_file_build_line_index(f)) {
+        return (n < f->line_count) ? f->line_index[n] : NULL;
+    }
+
+    /* No memory for the index, so walk the list. */
     list_foreach_struct(&f->line_list, line_item, line_item_t, link,
                         if (0 == n) {
                             return line_item->line;
@@ -176,3 +1192,158 @@ const char *read_file_get_line(read_file_t *f, size_t n) {
         );
     return NULL;
 }   /* read_file_get_line() */
+
+/* ------------------------------------------------------------------------- */
+const char *read_file_get_line_view(read_file_t *f, size_t n, size_t *size) {
+    const char *line = NULL;
+    size_t line_size = 0;
+
+    if ((NULL == f) || (n >= f->line_count)) {
+        line = NULL;
+    } else if (NULL != f->sidecar) {
+        size_t start = 0;
+        size_t end = 0;
+        read_file_sidecar_line(f->sidecar, n, &start, &end);
+        line = &f->map[start];
+        line_size = end - start;
+    } else if (READ_FILE_STORAGE_MMAP == f->storage) {
+        line = &f->map[f->line_offsets[n]];
+        line_size = f->line_offsets[n + 1] - f->line_offsets[n];
+    } else if (READ_FILE_STORAGE_CONTIGUOUS == f->storage) {
+        line = &f->data[f->line_offsets[n]];
+        line_size = f->line_offsets[n + 1] - f->line_offsets[n] - 1;
+    } else {
+        line = read_file_get_line(f, n);
+        line_size = (NULL == line) ? 0 : ((const line_item_t *) (line - offsetof(line_item_t, line)))->size;
+    }
+    if (NULL != size) {
+        *size = line_size;
+    }
+    return line;
+}   /* read_file_get_line_view() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Replace everything in @p f with a fresh load of its file.
+ *
+ * @return 1 on success, 0 on failure, in which case @p f is unchanged.
+ */
+static int read_file_reload(read_file_t *f) {
+    read_file_t *g = read_file_new_with_flags(f->filename, f->flags);
+    char *filename = f->filename;
+
+    if (NULL == g) {
+        return 0;
+    }
+    read_file_free_lines(f);
+    *f = *g;
+    f->filename = filename;
+    list_init(&f->line_list);
+    list_splice(&f->line_list, &g->line_list);
+    free(g->filename);
+    free(g);
+    return 1;
+}   /* read_file_reload() */
+
+/* ------------------------------------------------------------------------- */
+int read_file_refresh(read_file_t *f) {
+    struct stat st;
+    int fd = -1;
+    int ok = 0;
+
+    if ((NULL == f) || f->in_arena) {
+        return 0;
+    }
+    fd = open(f->filename, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (0 != fstat(fd, &st)) {
+        goto Done;
+    }
+    if ((st.st_dev != f->dev) || (st.st_ino != f->ino) || ((size_t) st.st_size < f->consumed) ||
+        (READ_FILE_COMPRESSION_NONE != f->compression)) {
+        close(fd);      /* Rotated, truncated, or can't be read from the middle. */
+        return read_file_reload(f);
+    }
+    if ((size_t) st.st_size == f->consumed) {
+        ok = 1;         /* Nothing new. */
+        goto Done;
+    }
+
+    /* A sidecar index can't grow, so switch to plain line offsets. */
+    if ((NULL != f->sidecar) && !read_file_sidecar_expand(f)) {
+        goto Done;
+    }
+
+    /* Re-read a last line that had no newline; it may have grown one. */
+    if (f->partial) {
+        read_file_remove_last_line(f);
+    }
+    free(f->line_index);
+    f->line_index = NULL;
+    if (READ_FILE_STORAGE_MMAP == f->storage) {
+        ok = read_file_map_lines(f, fd);
+    } else if (lseek(fd, (off_t) f->consumed, SEEK_SET) == (off_t) f->consumed) {
+        ok = read_file_read_lines(f, fd, f->flags);
+    }
+
+Done:
+    close(fd);
+    return ok;
+}   /* read_file_refresh() */
+
+/* ------------------------------------------------------------------------- */
+read_file_cursor_t *read_file_cursor_open(const char *filename) {
+    return read_file_cursor_open_with_flags(filename, 0);
+}   /* read_file_cursor_open() */
+
+/* ------------------------------------------------------------------------- */
+read_file_cursor_t *read_file_cursor_open_with_flags(const char *filename, unsigned int flags) {
+    read_file_cursor_t *c = NULL;
+    int fd = -1;
+
+    if (NULL == filename) {
+        return NULL;
+    }
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    c = malloc(sizeof(*c) + READ_FILE_CURSOR_BUFFER_SIZE + 1);
+    if (NULL == c) {
+        goto Error;
+    }
+    read_file_cursor_init(c, NULL, (char *) &c[1], READ_FILE_CURSOR_BUFFER_SIZE + 1);
+    c->source = read_file_source_open(fd, flags, read_file_detect_compression(fd), &c->fd_source);
+    if (NULL == c->source) {
+        goto Error;
+    }
+    c->fd = fd;
+#ifdef POSIX_FADV_SEQUENTIAL
+    (void) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return c;
+
+Error:
+    free(c);
+    close(fd);
+    return NULL;
+}   /* read_file_cursor_open_with_flags() */
+
+/* ------------------------------------------------------------------------- */
+int read_file_cursor_error(read_file_cursor_t *c) {
+    return (NULL == c) || c->error;
+}   /* read_file_cursor_error() */
+
+/* ------------------------------------------------------------------------- */
+void read_file_cursor_close(read_file_cursor_t *c) {
+    if (NULL != c) {
+        read_file_source_close(c->source);
+        if (c->fd >= 0) {
+            close(c->fd);
+        }
+        free(c->heap);
+        free(c);
+    }
+}   /* read_file_cursor_close() */
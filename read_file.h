@@ -9,6 +9,8 @@
  * of a file as a set of lines.
  */
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,13 +18,108 @@ extern "C" {
 typedef struct read_file_s read_file_t;
 
 /**
- * Read the contents of @p filename as a set of lines.
+ * Flags for `read_file_new_with_flags()`.
+ */
+#define READ_FILE_CONTIGUOUS    0x0001  /**< Keep all lines in one buffer rather than one allocation per line. */
+#define READ_FILE_MMAP          0x0002  /**< Map the file and leave the lines in place; see `read_file_new_mmap()`. */
+#define READ_FILE_ASYNC         0x0004  /**< Read ahead in a background thread while lines are split. */
+#define READ_FILE_SIDECAR_INDEX 0x0008  /**< With `READ_FILE_MMAP`, keep a line index in "filename.lidx". */
+
+/**
+ * Read the contents of @p filename as a set of lines. Lines of any length
+ * are kept whole.
+ *
+ * If read_file is built with "make ZLIB=1" or "make ZSTD=1", gzip or zstd
+ * files, found by their magic bytes, are decompressed as they are read,
+ * and the lines are those of the decompressed contents.
  *
  * @return a pointer to a read-file object containing all the lines of @p
  * filename, or `NULL` on error.
  */
 read_file_t *read_file_new(const char *filename);
 
+/**
+ * Like `read_file_new()`, but with @p flags (`READ_FILE_...` or'd
+ * together) controlling how the lines are stored.
+ *
+ * With `READ_FILE_CONTIGUOUS`, the lines are copied one after the other
+ * into a single buffer that doubles in size as needed, so a file is loaded
+ * with O(log n) allocations and freed with a constant number.
+ *
+ * With `READ_FILE_ASYNC`, a background thread reads the file into two
+ * large buffers in turn, so reading overlaps splitting. It has no effect
+ * with `READ_FILE_MMAP`.
+ *
+ * Compressed files can't be mapped, so `READ_FILE_MMAP` acts like
+ * `READ_FILE_CONTIGUOUS` for them.
+ *
+ * With `READ_FILE_MMAP | READ_FILE_SIDECAR_INDEX`, the line offsets are
+ * saved in a compact index next to the file, "filename.lidx", tied to the
+ * file's size, modification time and inode. Later opens of the unchanged
+ * file map the index instead of scanning the file, so opening a huge file
+ * for random access to its lines takes about as long as opening a small
+ * one. Each line lookup then decodes up to 64 offsets. The index is just
+ * a cache: if it can't be written, nothing fails.
+ */
+read_file_t *read_file_new_with_flags(const char *filename, unsigned int flags);
+
+/**
+ * Map @p filename into memory and find its lines without copying them,
+ * the same as `read_file_new_with_flags(filename, READ_FILE_MMAP)`.
+ * Processes mapping the same file share the page cache's copy of it.
+ *
+ * Mapped lines aren't NUL-terminated, so `read_file_get_line()` returns
+ * `NULL` for them; use `read_file_get_line_view()`. The file must not be
+ * truncated while it is mapped.
+ */
+read_file_t *read_file_new_mmap(const char *filename);
+
+/**
+ * Read @p filename into contiguous storage, as with `READ_FILE_CONTIGUOUS`,
+ * splitting lines on @p thread_count threads (or one per CPU if it is 0).
+ * The file is mapped and cut into byte ranges. Each thread counts the
+ * newlines in its range, then copies its range into place.
+ *
+ * Files that can't be mapped, or are compressed, are read by
+ * `read_file_new_with_flags()`.
+ */
+read_file_t *read_file_new_parallel(const char *filename, int thread_count);
+
+/*
+ * A batch is many files loaded together, all in memory owned by the batch.
+ */
+typedef struct read_file_batch_s read_file_batch_t;
+
+/**
+ * Load the @p n files named in @p paths, as with `READ_FILE_CONTIGUOUS`,
+ * on @p thread_count threads (or one per CPU if it is 0). Each thread
+ * takes the next file not yet started, and places what it loads in its
+ * own arena of large blocks, so loading many small files costs a few
+ * allocations rather than several each.
+ *
+ * @return the batch, or `NULL` if it can't be allocated. Files that can't
+ * be loaded are `NULL` in the batch.
+ */
+read_file_batch_t *read_file_load_batch(const char *const *paths, size_t n, int thread_count);
+
+/**
+ * @return the number of files in @p batch.
+ */
+size_t read_file_batch_count(read_file_batch_t *batch);
+
+/**
+ * @return the @p i-th file of @p batch, in the order of the paths given to
+ * `read_file_load_batch()`, or `NULL` if it couldn't be loaded. It belongs
+ * to the batch: `read_file_delete()` ignores it, and `read_file_refresh()`
+ * fails on it.
+ */
+read_file_t *read_file_batch_get(read_file_batch_t *batch, size_t i);
+
+/**
+ * Free @p batch and all of its files at once.
+ */
+void read_file_batch_delete(read_file_batch_t *batch);
+
 /**
  * Dispose of the read-file object @p f returned by `read_file_new()`.
  */
@@ -33,6 +130,21 @@ void read_file_delete(read_file_t *f);
  */
 void read_file_delete_null(read_file_t **f_ptr);
 
+/**
+ * Bring @p f up to date with its file, which may have grown. If it is
+ * still the same file (by inode) and no shorter, only the new complete
+ * lines are read and appended; a last line that had no newline is read
+ * again. Otherwise, as after log rotation or truncation, or if the file is
+ * compressed, the whole file is reloaded. The cost is proportional to the
+ * new data, unless the file is reloaded.
+ *
+ * Pointers to lines from @p f may be invalidated.
+ *
+ * @return 1 on success, 0 on failure, in which case @p f holds a prefix
+ * of the file's lines.
+ */
+int read_file_refresh(read_file_t *f);
+
 /**
  * @return the filename used (but copied) in `read_file_new()`, or `NULL` on
  * error.
@@ -47,9 +159,63 @@ size_t read_file_get_line_count(read_file_t *f);
 /**
  * @return a pointer to the (0-based) @p n-th line from @p f, or `NULL` on
  * error.
+ *
+ * The first call builds an index of the lines so that later calls take
+ * constant time. If that index can't be allocated, the lines are searched
+ * instead.
  */
 const char *read_file_get_line(read_file_t *f, size_t n);
 
+/**
+ * @return a pointer to the (0-based) @p n-th line from @p f, with its size
+ * in bytes, including any newline, in `*size`; or `NULL` on error. The
+ * line is not necessarily NUL-terminated.
+ */
+const char *read_file_get_line_view(read_file_t *f, size_t n, size_t *size);
+
+/*
+ * A cursor reads a file one line at a time through a buffer, so memory use
+ * depends on the length of the longest line rather than the size of the
+ * file. The buffer starts at 64 KiB and doubles as longer lines need it;
+ * only if it can't grow is a line handed out in pieces. Compressed files
+ * are decompressed, as for `read_file_new()`.
+ */
+typedef struct read_file_cursor_s read_file_cursor_t;
+
+/**
+ * Open @p filename for reading line by line.
+ *
+ * @return a cursor positioned before the first line, or `NULL` on error.
+ */
+read_file_cursor_t *read_file_cursor_open(const char *filename);
+
+/**
+ * Like `read_file_cursor_open()`, but with @p flags; only `READ_FILE_ASYNC`
+ * applies to cursors.
+ */
+read_file_cursor_t *read_file_cursor_open_with_flags(const char *filename, unsigned int flags);
+
+/**
+ * Advance @p c to its next line.
+ *
+ * @return a pointer to the NUL-terminated line, including any newline,
+ * with its size in bytes in `*size` if @p size is not `NULL`; or `NULL` at
+ * the end of the file or on error. The line is only valid until the next
+ * call on @p c.
+ */
+const char *read_file_cursor_next(read_file_cursor_t *c, size_t *size);
+
+/**
+ * @return non-zero if reading with @p c has failed, to tell an error from
+ * the end of the file after `read_file_cursor_next()` returns `NULL`.
+ */
+int read_file_cursor_error(read_file_cursor_t *c);
+
+/**
+ * Close the file and free @p c.
+ */
+void read_file_cursor_close(read_file_cursor_t *c);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,322 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "read_file_sidecar.h"
+
+#ifdef __APPLE__
+#define READ_FILE_MTIME_NSEC(_st)   ((_st)->st_mtimespec.tv_nsec)
+#else
+#define READ_FILE_MTIME_NSEC(_st)   ((_st)->st_mtim.tv_nsec)
+#endif
+
+struct read_file_sidecar_s {
+    const read_file_sidecar_header_t *header;  /**< Start of the mapping. */
+    size_t map_size;            /**< Size of the mapping. */
+    const read_file_checkpoint_t *checkpoints;
+    const unsigned char *lengths;
+    const unsigned char *lengths_end;
+};
+
+/* ------------------------------------------------------------------------- */
+/**
+ * @return the name of the sidecar of @p filename, on the heap, with room
+ * for @p extra more characters; or NULL on failure.
+ */
+static char *read_file_sidecar_name(const char *filename, size_t extra) {
+    size_t size = strlen(filename) + sizeof(READ_FILE_SIDECAR_SUFFIX);
+    char *name = malloc(size + extra);
+    if (NULL != name) {
+        memcpy(name, filename, size - sizeof(READ_FILE_SIDECAR_SUFFIX));
+        memcpy(&name[size - sizeof(READ_FILE_SIDECAR_SUFFIX)], READ_FILE_SIDECAR_SUFFIX, sizeof(READ_FILE_SIDECAR_SUFFIX));
+    }
+    return name;
+}   /* read_file_sidecar_name() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Fill in @p header for a file with status @p st and @p line_count lines.
+ */
+static void read_file_sidecar_header_init(read_file_sidecar_header_t *header, const struct stat *st, size_t line_count) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, READ_FILE_SIDECAR_MAGIC, sizeof(header->magic));
+    header->version = READ_FILE_SIDECAR_VERSION;
+    header->interval = READ_FILE_SIDECAR_INTERVAL;
+    header->size = (uint64_t) st->st_size;
+    header->mtime_sec = (int64_t) st->st_mtime;
+    header->mtime_nsec = (int64_t) READ_FILE_MTIME_NSEC(st);
+    header->ino = (uint64_t) st->st_ino;
+    header->dev = (uint64_t) st->st_dev;
+    header->line_count = line_count;
+}   /* read_file_sidecar_header_init() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * @return 1 if @p header of a sidecar of @p map_size bytes matches a file
+ * with status @p st, 0 otherwise.
+ */
+static int read_file_sidecar_header_valid(const read_file_sidecar_header_t *header, size_t map_size,
+                                          const struct stat *st) {
+    read_file_sidecar_header_t expected;
+    uint64_t checkpoints = 0;
+
+    read_file_sidecar_header_init(&expected, st, header->line_count);
+    expected.lengths_size = header->lengths_size;
+    if (0 != memcmp(header, &expected, sizeof(expected))) {
+        return 0;
+    }
+
+    /* Every line has at least one byte, which also keeps the sums below small. */
+    if (header->line_count > header->size) {
+        return 0;
+    }
+    checkpoints = (header->line_count + READ_FILE_SIDECAR_INTERVAL - 1) / READ_FILE_SIDECAR_INTERVAL;
+    return (header->lengths_size <= map_size) &&
+        (map_size == sizeof(*header) + checkpoints * sizeof(read_file_checkpoint_t) + header->lengths_size);
+}   /* read_file_sidecar_header_valid() */
+
+/* ------------------------------------------------------------------------- */
+read_file_sidecar_t *read_file_sidecar_open(const char *filename, const struct stat *st) {
+    read_file_sidecar_t *sidecar = NULL;
+    char *name = read_file_sidecar_name(filename, 0);
+    struct stat sidecar_st;
+    void *map = MAP_FAILED;
+    size_t checkpoint_count = 0;
+    size_t i = 0;
+    int fd = -1;
+
+    if (NULL == name) {
+        return NULL;
+    }
+    fd = open(name, O_RDONLY);
+    free(name);
+    if (fd < 0) {
+        return NULL;
+    }
+    if ((0 != fstat(fd, &sidecar_st)) || (sidecar_st.st_size < (off_t) sizeof(read_file_sidecar_header_t)) ||
+        (MAP_FAILED == (map = mmap(NULL, (size_t) sidecar_st.st_size, PROT_READ, MAP_SHARED, fd, 0)))) {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+    if (!read_file_sidecar_header_valid(map, (size_t) sidecar_st.st_size, st)) {
+        goto Error;
+    }
+    sidecar = malloc(sizeof(*sidecar));
+    if (NULL == sidecar) {
+        goto Error;
+    }
+    sidecar->header = map;
+    sidecar->map_size = (size_t) sidecar_st.st_size;
+    sidecar->checkpoints = (const read_file_checkpoint_t *) &sidecar->header[1];
+    checkpoint_count = (sidecar->header->line_count + READ_FILE_SIDECAR_INTERVAL - 1) / READ_FILE_SIDECAR_INTERVAL;
+    sidecar->lengths = (const unsigned char *) &sidecar->checkpoints[checkpoint_count];
+    sidecar->lengths_end = sidecar->lengths + sidecar->header->lengths_size;
+
+    /* Then nothing read through a checkpoint can go out of bounds. */
+    for (i = 0; i < checkpoint_count; ++i) {
+        if ((sidecar->checkpoints[i].offset >= sidecar->header->size) ||
+            (sidecar->checkpoints[i].lengths_offset > sidecar->header->lengths_size)) {
+            goto Error;
+        }
+    }
+    return sidecar;
+
+Error:
+    free(sidecar);
+    munmap(map, (size_t) sidecar_st.st_size);
+    return NULL;
+}   /* read_file_sidecar_open() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Write @p value to @p file as a LEB128 varint: seven bits per byte, low
+ * bits first, with the top bit set on all but the last byte.
+ *
+ * @return the number of bytes written.
+ */
+static size_t read_file_sidecar_put_varint(FILE *file, uint64_t value) {
+    size_t bytes = 1;
+    while (value >= 0x80) {
+        putc((int) (value & 0x7F) | 0x80, file);
+        value >>= 7;
+        bytes++;
+    }
+    putc((int) value, file);
+    return bytes;
+}   /* read_file_sidecar_put_varint() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * @return the mode for a new sidecar: 0666 less the process's umask, as
+ * open() would give, or mkstemp()'s 0600 if the umask can't be read. It is
+ * read from /proc rather than with umask(), which would briefly change it
+ * for every thread.
+ */
+static mode_t read_file_sidecar_mode(void) {
+    mode_t mode = 0600;
+    unsigned int mask = 0;
+    char line[64];
+    FILE *file = fopen("/proc/self/status", "r");
+
+    if (NULL == file) {
+        return mode;
+    }
+    while (NULL != fgets(line, sizeof(line), file)) {
+        if (1 == sscanf(line, "Umask: %o", &mask)) {
+            mode = 0666 & ~(mode_t) mask;
+            break;
+        }
+    }
+    fclose(file);
+    return mode;
+}   /* read_file_sidecar_mode() */
+
+/* ------------------------------------------------------------------------- */
+int read_file_sidecar_write(const char *filename, const struct stat *st,
+                            const size_t *line_offsets, size_t line_count) {
+    static const char temp_suffix[] = ".XXXXXX";    /* For mkstemp(). */
+    read_file_sidecar_header_t header;
+    read_file_checkpoint_t *checkpoints = NULL;
+    size_t checkpoint_count = (line_count + READ_FILE_SIDECAR_INTERVAL - 1) / READ_FILE_SIDECAR_INTERVAL;
+    char *name = read_file_sidecar_name(filename, 0);
+    char *temp_name = read_file_sidecar_name(filename, sizeof(temp_suffix) - 1);
+    FILE *file = NULL;
+    size_t i = 0;
+    int fd = -1;
+    int ok = 0;
+
+    if ((NULL == name) || (NULL == temp_name)) {
+        goto Done;
+    }
+    checkpoints = calloc(checkpoint_count + 1, sizeof(checkpoints[0]));
+    if (NULL == checkpoints) {
+        goto Done;
+    }
+    strcat(temp_name, temp_suffix);
+    fd = mkstemp(temp_name);
+    if (fd < 0) {
+        goto Done;
+    }
+    if ((0 != fchmod(fd, read_file_sidecar_mode())) || (NULL == (file = fdopen(fd, "wb")))) {
+        goto Done;
+    }
+    fd = -1;    /* Now closed with file. */
+
+    /* The checkpoints come before the lengths, but are found along with them. */
+    read_file_sidecar_header_init(&header, st, line_count);
+    if (0 != fseek(file, (long) (sizeof(header) + checkpoint_count * sizeof(checkpoints[0])), SEEK_SET)) {
+        goto Done;
+    }
+    for (i = 0; i < line_count; ++i) {
+        if (0 == i % READ_FILE_SIDECAR_INTERVAL) {
+            checkpoints[i / READ_FILE_SIDECAR_INTERVAL].offset = line_offsets[i];
+            checkpoints[i / READ_FILE_SIDECAR_INTERVAL].lengths_offset = header.lengths_size;
+        } else {
+            header.lengths_size += read_file_sidecar_put_varint(file, line_offsets[i] - line_offsets[i - 1]);
+        }
+    }
+    if (ferror(file) || (0 != fseek(file, 0, SEEK_SET))) {
+        goto Done;
+    }
+    ok = (1 == fwrite(&header, sizeof(header), 1, file)) &&
+        (checkpoint_count == fwrite(checkpoints, sizeof(checkpoints[0]), checkpoint_count, file));
+
+Done:
+    if (NULL != file) {
+        ok = !ferror(file) && ok;
+        ok = (0 == fclose(file)) && ok;
+    } else if (fd >= 0) {
+        close(fd);
+    }
+    if ((NULL != file) || (fd >= 0)) {
+        /* Only a complete sidecar is renamed into place. */
+        ok = ok && (0 == rename(temp_name, name));
+        if (!ok) {
+            unlink(temp_name);
+        }
+    }
+    free(checkpoints);
+    free(temp_name);
+    free(name);
+    return ok;
+}   /* read_file_sidecar_write() */
+
+/* ------------------------------------------------------------------------- */
+size_t read_file_sidecar_line_count(const read_file_sidecar_t *sidecar) {
+    return (size_t) sidecar->header->line_count;
+}   /* read_file_sidecar_line_count() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Read a varint at @p *p, which must be before @p end, and advance @p *p
+ * past it.
+ *
+ * @return the value read; a damaged varint reads as a large value.
+ */
+static uint64_t read_file_sidecar_get_varint(const unsigned char **p, const unsigned char *end) {
+    uint64_t value = 0;
+    unsigned int shift = 0;
+    while (*p < end) {
+        unsigned char byte = *(*p)++;
+        if (shift < 64) {
+            value |= (uint64_t) (byte & 0x7F) << shift;
+        }
+        if (0 == (byte & 0x80)) {
+            return value;
+        }
+        shift += 7;
+    }
+    return UINT64_MAX;
+}   /* read_file_sidecar_get_varint() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * @return @p offset plus @p length, but no more than @p size, so that a
+ * damaged sidecar can't give lines outside the file.
+ */
+static uint64_t read_file_sidecar_add(uint64_t offset, uint64_t length, uint64_t size) {
+    return (length > size - offset) ? size : offset + length;
+}   /* read_file_sidecar_add() */
+
+/* ------------------------------------------------------------------------- */
+void read_file_sidecar_line(const read_file_sidecar_t *sidecar, size_t n, size_t *start, size_t *end) {
+    const read_file_checkpoint_t *checkpoint = &sidecar->checkpoints[n / READ_FILE_SIDECAR_INTERVAL];
+    const unsigned char *p = &sidecar->lengths[checkpoint->lengths_offset];
+    uint64_t size = sidecar->header->size;
+    uint64_t offset = checkpoint->offset;
+    uint64_t next = 0;
+    size_t i = 0;
+
+    assert(n < sidecar->header->line_count);
+    for (i = 0; (i < n % READ_FILE_SIDECAR_INTERVAL) && (offset < size); ++i) {
+        offset = read_file_sidecar_add(offset, read_file_sidecar_get_varint(&p, sidecar->lengths_end), size);
+    }
+    if (n + 1 == sidecar->header->line_count) {
+        next = size;
+    } else if (0 == (n + 1) % READ_FILE_SIDECAR_INTERVAL) {
+        next = checkpoint[1].offset;
+    } else {
+        next = read_file_sidecar_add(offset, read_file_sidecar_get_varint(&p, sidecar->lengths_end), size);
+    }
+    if (next < offset) {
+        next = size;    /* Damaged. */
+    }
+    *start = (size_t) offset;
+    *end = (size_t) next;
+}   /* read_file_sidecar_line() */
+
+/* ------------------------------------------------------------------------- */
+void read_file_sidecar_close(read_file_sidecar_t *sidecar) {
+    if (NULL != sidecar) {
+        munmap((void *) sidecar->header, sidecar->map_size);
+        free(sidecar);
+    }
+}   /* read_file_sidecar_close() */
@@ -0,0 +1,102 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#ifndef MALLMOCK_READ_FILE_SIDECAR_H_
+#define MALLMOCK_READ_FILE_SIDECAR_H_
+
+/*
+ * Sidecar line indexes for read_file.c. This is internal to read_file.c;
+ * it isn't part of the read_file.h interface.
+ *
+ * The sidecar of "name" is "name.lidx". It holds the offset of the start
+ * of every line of "name", keyed by the size, modification time, inode and
+ * device of "name" so that it is only used while "name" is unchanged. All
+ * numbers are in host byte order; a sidecar from another kind of machine
+ * is ignored as invalid.
+ *
+ * Layout:
+ *
+ *   read_file_sidecar_header_t
+ *   read_file_checkpoint_t for lines 0, INTERVAL, 2 * INTERVAL, ...
+ *   the length of every other line, as LEB128 varints
+ *
+ * So finding a line takes one checkpoint and at most INTERVAL - 1 varints,
+ * and a file of short lines gets an index of little more than a byte per
+ * line.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lines between checkpoints.
+ */
+#define READ_FILE_SIDECAR_INTERVAL  64
+
+#define READ_FILE_SIDECAR_SUFFIX    ".lidx"
+#define READ_FILE_SIDECAR_MAGIC     "RFLIDX\r\n"
+#define READ_FILE_SIDECAR_VERSION   1
+
+typedef struct read_file_sidecar_header_s {
+    char magic[8];              /**< READ_FILE_SIDECAR_MAGIC. */
+    uint32_t version;           /**< READ_FILE_SIDECAR_VERSION. */
+    uint32_t interval;          /**< READ_FILE_SIDECAR_INTERVAL. */
+    uint64_t size;              /**< Size of the file. */
+    int64_t mtime_sec;          /**< Modification time of the file. */
+    int64_t mtime_nsec;
+    uint64_t ino;               /**< Inode of the file. */
+    uint64_t dev;               /**< Device of the file. */
+    uint64_t line_count;        /**< Lines in the file. */
+    uint64_t lengths_size;      /**< Bytes of varint line lengths. */
+} read_file_sidecar_header_t;
+
+typedef struct read_file_checkpoint_s {
+    uint64_t offset;            /**< Start of the line in the file. */
+    uint64_t lengths_offset;    /**< Where the lengths of the following lines start. */
+} read_file_checkpoint_t;
+
+typedef struct read_file_sidecar_s read_file_sidecar_t;
+
+/**
+ * Map the sidecar of @p filename, whose status is @p st.
+ *
+ * @return the sidecar, or `NULL` if there is none, it doesn't match
+ * @p st, or it is damaged.
+ */
+read_file_sidecar_t *read_file_sidecar_open(const char *filename, const struct stat *st);
+
+/**
+ * Write the sidecar of @p filename, whose status is @p st, for the
+ * @p line_count lines starting at @p line_offsets. It is written under a
+ * temporary name and renamed into place, so readers never see part of one.
+ *
+ * @return 1 on success, 0 on failure.
+ */
+int read_file_sidecar_write(const char *filename, const struct stat *st,
+                            const size_t *line_offsets, size_t line_count);
+
+/**
+ * @return the number of lines indexed by @p sidecar.
+ */
+size_t read_file_sidecar_line_count(const read_file_sidecar_t *sidecar);
+
+/**
+ * Find line @p n, which must be less than the line count, putting its
+ * start and end offsets in the file in `*start` and `*end`.
+ */
+void read_file_sidecar_line(const read_file_sidecar_t *sidecar, size_t n, size_t *start, size_t *end);
+
+/**
+ * Unmap and free @p sidecar.
+ */
+void read_file_sidecar_close(read_file_sidecar_t *sidecar);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MALLMOCK_READ_FILE_SIDECAR_H_
@@ -0,0 +1,389 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef READ_FILE_ZLIB
+#include <limits.h>
+#include <zlib.h>
+#endif
+#ifdef READ_FILE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "read_file_source.h"
+
+/* ------------------------------------------------------------------------- */
+/**
+ * read() all of @p size bytes unless the end of the file comes first.
+ *
+ * @return the number of bytes read, or -1 on error.
+ */
+static ssize_t read_fully(int fd, char *buf, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t bytes_read = read(fd, &buf[total], size - total);
+        if (bytes_read > 0) {
+            total += bytes_read;
+        } else if (0 == bytes_read) {
+            break;
+        } else if (EINTR != errno) {
+            return -1;
+        }
+    }
+    return (ssize_t) total;
+}   /* read_fully() */
+
+/* ------------------------------------------------------------------------- */
+static ssize_t read_file_fd_source_read(read_file_source_t *source, char *buf, size_t size) {
+    read_file_fd_source_t *s = (read_file_fd_source_t *) source;
+    for (;;) {
+        ssize_t bytes_read = read(s->fd, buf, size);
+        if ((bytes_read >= 0) || (EINTR != errno)) {
+            return bytes_read;
+        }
+    }
+}   /* read_file_fd_source_read() */
+
+/* ------------------------------------------------------------------------- */
+static void read_file_fd_source_close(read_file_source_t *source) {
+}   /* read_file_fd_source_close() */
+
+/* ------------------------------------------------------------------------- */
+read_file_source_t *read_file_fd_source_init(read_file_fd_source_t *s, int fd) {
+    assert(NULL != s);
+    s->source.read = read_file_fd_source_read;
+    s->source.close = read_file_fd_source_close;
+    s->fd = fd;
+    return &s->source;
+}   /* read_file_fd_source_init() */
+
+/**
+ * One of the async source's buffers. It is either being filled by the
+ * thread or, once full, being emptied by the caller.
+ */
+typedef struct async_buffer_s {
+    char *data;
+    ssize_t size;      /**< Bytes in data; 0 at the end of the file, -1 on error. */
+    size_t offset;     /**< Bytes already handed to the caller. */
+    int full;          /**< Whether the thread has finished filling it. */
+} async_buffer_t;
+
+typedef struct read_file_async_source_s {
+    read_file_source_t source;
+    int fd;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;       /**< Signalled whenever a buffer changes hands. */
+    async_buffer_t buffers[2];
+    int consumer;              /**< Index of the buffer the caller reads from. */
+    int stop;                  /**< Set to make the thread exit. */
+} read_file_async_source_t;
+
+/* ------------------------------------------------------------------------- */
+static void *read_file_async_thread(void *arg) {
+    read_file_async_source_t *s = (read_file_async_source_t *) arg;
+    int producer = 0;
+
+    for (;;) {
+        async_buffer_t *b = &s->buffers[producer];
+        ssize_t size = 0;
+
+        pthread_mutex_lock(&s->mutex);
+        while (b->full && !s->stop) {
+            pthread_cond_wait(&s->cond, &s->mutex);
+        }
+        if (s->stop) {
+            pthread_mutex_unlock(&s->mutex);
+            break;
+        }
+        pthread_mutex_unlock(&s->mutex);
+
+        size = read_fully(s->fd, b->data, READ_FILE_ASYNC_BUFFER_SIZE);
+
+        pthread_mutex_lock(&s->mutex);
+        b->size = size;
+        b->offset = 0;
+        b->full = 1;
+        pthread_cond_broadcast(&s->cond);
+        pthread_mutex_unlock(&s->mutex);
+        if (size <= 0) {
+            break;      /* The end, or an error; either way it sticks. */
+        }
+        producer ^= 1;
+    }
+    return NULL;
+}   /* read_file_async_thread() */
+
+/* ------------------------------------------------------------------------- */
+static ssize_t read_file_async_source_read(read_file_source_t *source, char *buf, size_t size) {
+    read_file_async_source_t *s = (read_file_async_source_t *) source;
+    async_buffer_t *b = &s->buffers[s->consumer];
+    size_t bytes = 0;
+
+    pthread_mutex_lock(&s->mutex);
+    while (!b->full) {
+        pthread_cond_wait(&s->cond, &s->mutex);
+    }
+    pthread_mutex_unlock(&s->mutex);
+    if (b->size <= 0) {
+        return b->size;
+    }
+
+    bytes = (size_t) b->size - b->offset;
+    if (bytes > size) {
+        bytes = size;
+    }
+    memcpy(buf, &b->data[b->offset], bytes);
+    b->offset += bytes;
+    if (b->offset == (size_t) b->size) {
+        /* Hand the buffer back to the thread. */
+        pthread_mutex_lock(&s->mutex);
+        b->full = 0;
+        pthread_cond_broadcast(&s->cond);
+        pthread_mutex_unlock(&s->mutex);
+        s->consumer ^= 1;
+    }
+    return (ssize_t) bytes;
+}   /* read_file_async_source_read() */
+
+/* ------------------------------------------------------------------------- */
+static void read_file_async_source_close(read_file_source_t *source) {
+    read_file_async_source_t *s = (read_file_async_source_t *) source;
+
+    pthread_mutex_lock(&s->mutex);
+    s->stop = 1;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+    pthread_join(s->thread, NULL);
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->mutex);
+    free(s);
+}   /* read_file_async_source_close() */
+
+/* ------------------------------------------------------------------------- */
+read_file_source_t *read_file_async_source_new(int fd) {
+    read_file_async_source_t *s = NULL;
+    char *data = NULL;
+
+    /* The source and both buffers in one allocation. */
+    s = calloc(1, sizeof(*s) + 2 * READ_FILE_ASYNC_BUFFER_SIZE);
+    if (NULL == s) {
+        return NULL;
+    }
+    data = (char *) &s[1];
+    s->source.read = read_file_async_source_read;
+    s->source.close = read_file_async_source_close;
+    s->fd = fd;
+    s->buffers[0].data = data;
+    s->buffers[1].data = data + READ_FILE_ASYNC_BUFFER_SIZE;
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    if (0 != pthread_create(&s->thread, NULL, read_file_async_thread, s)) {
+        pthread_cond_destroy(&s->cond);
+        pthread_mutex_destroy(&s->mutex);
+        free(s);
+        return NULL;
+    }
+    return &s->source;
+}   /* read_file_async_source_new() */
+
+/* ------------------------------------------------------------------------- */
+read_file_compression_t read_file_detect_compression(int fd) {
+    unsigned char magic[4];
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+
+    if ((offset < 0) || (pread(fd, magic, sizeof(magic), offset) != sizeof(magic))) {
+        return READ_FILE_COMPRESSION_NONE;
+    }
+#ifdef READ_FILE_ZLIB
+    if ((0x1F == magic[0]) && (0x8B == magic[1])) {
+        return READ_FILE_COMPRESSION_GZIP;
+    }
+#endif
+#ifdef READ_FILE_ZSTD
+    if ((0x28 == magic[0]) && (0xB5 == magic[1]) && (0x2F == magic[2]) && (0xFD == magic[3])) {
+        return READ_FILE_COMPRESSION_ZSTD;
+    }
+#endif
+    return READ_FILE_COMPRESSION_NONE;
+}   /* read_file_detect_compression() */
+
+#if defined(READ_FILE_ZLIB) || defined(READ_FILE_ZSTD)
+
+typedef struct read_file_decompress_source_s {
+    read_file_source_t source;
+    read_file_source_t *input;  /**< Where the compressed bytes come from. */
+    read_file_compression_t compression;
+#ifdef READ_FILE_ZLIB
+    z_stream z;
+#endif
+#ifdef READ_FILE_ZSTD
+    ZSTD_DCtx *zstd;
+    ZSTD_inBuffer zstd_in;
+#endif
+    int eof;           /**< Whether input has returned 0. */
+    int error;         /**< Whether input or the decompressor has failed. */
+    int pending;       /**< Whether a stream was started but not ended. */
+    char buf[READ_FILE_DECOMPRESS_BUFFER_SIZE];  /**< Compressed bytes. */
+} read_file_decompress_source_t;
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Read more compressed bytes into the buffer of @p s.
+ *
+ * @return the number of bytes read, or 0 at the end of the input or on
+ * error.
+ */
+static size_t read_file_decompress_fill(read_file_decompress_source_t *s) {
+    ssize_t bytes = read_file_source_read(s->input, s->buf, sizeof(s->buf));
+    if (bytes < 0) {
+        s->error = 1;
+    } else if (0 == bytes) {
+        s->eof = 1;
+    }
+    return (bytes > 0) ? (size_t) bytes : 0;
+}   /* read_file_decompress_fill() */
+
+#ifdef READ_FILE_ZLIB
+/* ------------------------------------------------------------------------- */
+/**
+ * Inflate into @p buf. Concatenated gzip members, as from "cat a.gz b.gz",
+ * are inflated one after the other.
+ */
+static ssize_t read_file_gzip_read(read_file_decompress_source_t *s, char *buf, size_t size) {
+    s->z.next_out = (Bytef *) buf;
+    s->z.avail_out = (uInt) ((size > UINT_MAX) ? UINT_MAX : size);
+    while ((s->z.next_out == (Bytef *) buf) && !s->error) {
+        int status = Z_OK;
+        if (0 == s->z.avail_in) {
+            if (s->eof || (0 == (s->z.avail_in = (uInt) read_file_decompress_fill(s)))) {
+                break;
+            }
+            s->z.next_in = (Bytef *) s->buf;
+        }
+        if (!s->pending) {
+            if (Z_OK != inflateReset(&s->z)) {
+                s->error = 1;
+                break;
+            }
+            s->pending = 1;
+        }
+        status = inflate(&s->z, Z_NO_FLUSH);
+        if (Z_STREAM_END == status) {
+            s->pending = 0;
+        } else if ((Z_OK != status) && (Z_BUF_ERROR != status)) {
+            s->error = 1;
+        }
+    }
+    if (s->z.next_out != (Bytef *) buf) {
+        return (char *) s->z.next_out - buf;
+    }
+    return (s->error || s->pending) ? -1 : 0;
+}   /* read_file_gzip_read() */
+#endif
+
+#ifdef READ_FILE_ZSTD
+/* ------------------------------------------------------------------------- */
+/**
+ * Decompress into @p buf. Concatenated frames are decompressed one after
+ * the other.
+ */
+static ssize_t read_file_zstd_read(read_file_decompress_source_t *s, char *buf, size_t size) {
+    ZSTD_outBuffer out = { buf, size, 0 };
+    while ((0 == out.pos) && !s->error) {
+        size_t status = 0;
+        if (s->zstd_in.pos == s->zstd_in.size) {
+            if (s->eof || (0 == (s->zstd_in.size = read_file_decompress_fill(s)))) {
+                break;
+            }
+            s->zstd_in.src = s->buf;
+            s->zstd_in.pos = 0;
+        }
+        status = ZSTD_decompressStream(s->zstd, &out, &s->zstd_in);
+        if (ZSTD_isError(status)) {
+            s->error = 1;
+        } else {
+            s->pending = (0 != status);
+        }
+    }
+    if (out.pos > 0) {
+        return (ssize_t) out.pos;
+    }
+    return (s->error || s->pending) ? -1 : 0;
+}   /* read_file_zstd_read() */
+#endif
+
+/* ------------------------------------------------------------------------- */
+static ssize_t read_file_decompress_source_read(read_file_source_t *source, char *buf, size_t size) {
+    read_file_decompress_source_t *s = (read_file_decompress_source_t *) source;
+#ifdef READ_FILE_ZLIB
+    if (READ_FILE_COMPRESSION_GZIP == s->compression) {
+        return read_file_gzip_read(s, buf, size);
+    }
+#endif
+#ifdef READ_FILE_ZSTD
+    if (READ_FILE_COMPRESSION_ZSTD == s->compression) {
+        return read_file_zstd_read(s, buf, size);
+    }
+#endif
+    return -1;
+}   /* read_file_decompress_source_read() */
+
+/* ------------------------------------------------------------------------- */
+static void read_file_decompress_source_close(read_file_source_t *source) {
+    read_file_decompress_source_t *s = (read_file_decompress_source_t *) source;
+#ifdef READ_FILE_ZLIB
+    if (READ_FILE_COMPRESSION_GZIP == s->compression) {
+        inflateEnd(&s->z);
+    }
+#endif
+#ifdef READ_FILE_ZSTD
+    if (READ_FILE_COMPRESSION_ZSTD == s->compression) {
+        ZSTD_freeDCtx(s->zstd);
+    }
+#endif
+    read_file_source_close(s->input);
+    free(s);
+}   /* read_file_decompress_source_close() */
+
+#endif  /* READ_FILE_ZLIB || READ_FILE_ZSTD */
+
+/* ------------------------------------------------------------------------- */
+read_file_source_t *read_file_decompress_source_new(read_file_source_t *input, read_file_compression_t compression) {
+#if defined(READ_FILE_ZLIB) || defined(READ_FILE_ZSTD)
+    read_file_decompress_source_t *s = calloc(1, sizeof(*s));
+    int ok = 0;
+
+    if (NULL == s) {
+        return NULL;
+    }
+    s->source.read = read_file_decompress_source_read;
+    s->source.close = read_file_decompress_source_close;
+    s->input = input;
+    s->compression = compression;
+#ifdef READ_FILE_ZLIB
+    if (READ_FILE_COMPRESSION_GZIP == compression) {
+        /* 16 + MAX_WBITS for gzip rather than zlib headers. */
+        ok = (Z_OK == inflateInit2(&s->z, 16 + MAX_WBITS));
+    }
+#endif
+#ifdef READ_FILE_ZSTD
+    if (READ_FILE_COMPRESSION_ZSTD == compression) {
+        ok = (NULL != (s->zstd = ZSTD_createDCtx()));
+    }
+#endif
+    if (!ok) {
+        free(s);
+        return NULL;
+    }
+    return &s->source;
+#else
+    return NULL;
+#endif
+}   /* read_file_decompress_source_new() */
@@ -0,0 +1,111 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#ifndef MALLMOCK_READ_FILE_SOURCE_H_
+#define MALLMOCK_READ_FILE_SOURCE_H_
+
+/*
+ * Byte sources for the line cursor in read_file.c. This is internal to
+ * read_file.c; it isn't part of the read_file.h interface.
+ *
+ * A source reads from a file descriptor that it doesn't own. The plain
+ * source just calls read(). The async source reads ahead into two large
+ * buffers from a background thread, so that the disk stays busy while the
+ * caller splits lines. A decompressing source reads compressed bytes from
+ * another source and hands out the decompressed ones.
+ */
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct read_file_source_s read_file_source_t;
+
+struct read_file_source_s {
+    /**
+     * @return the number of bytes (at most @p size) put in @p buf, 0 at the
+     * end of the input, or -1 on error.
+     */
+    ssize_t (*read)(read_file_source_t *source, char *buf, size_t size);
+
+    /**
+     * Stop reading and free anything @p source allocated.
+     */
+    void (*close)(read_file_source_t *source);
+};
+
+typedef struct read_file_fd_source_s {
+    read_file_source_t source;
+    int fd;
+} read_file_fd_source_t;
+
+/**
+ * Set up @p s to read() from @p fd.
+ *
+ * @return the source within @p s.
+ */
+read_file_source_t *read_file_fd_source_init(read_file_fd_source_t *s, int fd);
+
+/**
+ * Size of each of the async source's two buffers.
+ */
+#define READ_FILE_ASYNC_BUFFER_SIZE     0x100000
+
+/**
+ * Start a thread reading @p fd ahead of the caller.
+ *
+ * @return the new source, or `NULL` on error.
+ */
+read_file_source_t *read_file_async_source_new(int fd);
+
+/**
+ * Compressed formats that a decompressing source can read. Only those
+ * built in, with "make ZLIB=1" or "make ZSTD=1", are ever detected.
+ */
+typedef enum read_file_compression_e {
+    READ_FILE_COMPRESSION_NONE,
+    READ_FILE_COMPRESSION_GZIP,
+    READ_FILE_COMPRESSION_ZSTD,
+} read_file_compression_t;
+
+/**
+ * Look at the magic bytes at the current offset of @p fd, without moving
+ * it.
+ *
+ * @return the compression of the rest of @p fd, or
+ * `READ_FILE_COMPRESSION_NONE` if it isn't compressed, its format isn't
+ * built in, or it can't be looked at (a pipe, say).
+ */
+read_file_compression_t read_file_detect_compression(int fd);
+
+/**
+ * Size of a decompressing source's buffer of compressed bytes.
+ */
+#define READ_FILE_DECOMPRESS_BUFFER_SIZE    0x10000
+
+/**
+ * Start decompressing @p input, which is in format @p compression. The new
+ * source owns @p input, and closes it when it is closed.
+ *
+ * @return the new source, or `NULL` on error, in which case @p input is
+ * left open.
+ */
+read_file_source_t *read_file_decompress_source_new(read_file_source_t *input, read_file_compression_t compression);
+
+static inline ssize_t read_file_source_read(read_file_source_t *source, char *buf, size_t size) {
+    return source->read(source, buf, size);
+}   /* read_file_source_read() */
+
+static inline void read_file_source_close(read_file_source_t *source) {
+    if (NULL != source) {
+        source->close(source);
+    }
+}   /* read_file_source_close() */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MALLMOCK_READ_FILE_SOURCE_H_
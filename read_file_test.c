@@ -6,11 +6,23 @@
  */
 
 #include <assert.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef READ_FILE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef READ_FILE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "cut.h"
 #include "mallmock.h"
 #include "read_file.h"
@@ -173,15 +185,850 @@ static cut_result_t test_read_file_low_memory(test_t *test) {
     CUT_ASSERT_STRING("they revel in that warmth of inertia where they live\n", read_file_get_line(test->rf, 1));
     CUT_ASSERT_STRING("until, forgotten, they rot and die.\n", read_file_get_line(test->rf, 2));
     CUT_ASSERT_NULL(read_file_get_line(test->rf, 4));
+
+    /* Without memory for the line index, lines are still found. */
+    read_file_delete_null(&test->rf);
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new(test->filename));
+    mallmock_set_any_alloc_return(NULL, 0);
+    CUT_ASSERT_STRING("until, forgotten, they rot and die.\n", read_file_get_line(test->rf, 2));
+    CUT_ASSERT_NULL(read_file_get_line(test->rf, 3));
     CUT_TEST_PASS();
 }   /* test_read_file_low_memory() */
 
+/* ------------------------------------------------------------------------- */
+/**
+ * Create a test file of @p line_count numbered lines.
+ */
+static cut_result_t create_numbered_test_file(test_t *test, size_t line_count) {
+    char *contents = NULL;
+    size_t offset = 0;
+    size_t i = 0;
+    cut_result_t result = CUT_RESULT_PASS;
+
+    contents = malloc(line_count * 32 + 1);
+    if (NULL == contents) {
+        return CUT_RESULT_ERROR;
+    }
+    contents[0] = 0;
+    for (i = 0; i < line_count; ++i) {
+        offset += sprintf(&contents[offset], "line %zu\n", i);
+    }
+    result = create_test_file(test, contents);
+    free(contents);
+    return result;
+}   /* create_numbered_test_file() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Check that @p test->rf holds the lines written by
+ * create_numbered_test_file().
+ */
+static cut_result_t check_numbered_lines(const char *file, int line, test_t *test, size_t line_count) {
+    char expected[32];
+    size_t i = 0;
+
+    CUT_FL_ASSERT_INT(file, line, line_count, read_file_get_line_count(test->rf));
+    for (i = line_count; i-- > 0; ) {
+        sprintf(expected, "line %zu\n", i);
+        CUT_FL_ASSERT_STRING(file, line, expected, read_file_get_line(test->rf, i));
+    }
+    CUT_FL_ASSERT_NULL(file, line, read_file_get_line(test->rf, line_count));
+    return CUT_RESULT_PASS;
+}   /* check_numbered_lines() */
+
+#define CHECK_NUMBERED_LINES(_test,_count)  CUT_RETURN(check_numbered_lines(__FILE__, __LINE__, (_test), (_count)))
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_many_lines(test_t *test) {
+    const size_t line_count = 20000;
+
+    CUT_RETURN(create_numbered_test_file(test, line_count));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new(test->filename));
+    CHECK_NUMBERED_LINES(test, line_count);
+    CUT_TEST_PASS();
+}   /* test_read_file_many_lines() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_contiguous(test_t *test) {
+    const size_t line_count = 20000;
+    size_t successes = 0;
+
+    CUT_RETURN(create_test_file(test, "no newline"));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, READ_FILE_CONTIGUOUS));
+    CUT_ASSERT_INT(1, read_file_get_line_count(test->rf));
+    CUT_ASSERT_STRING("no newline", read_file_get_line(test->rf, 0));
+
+    CUT_RETURN(create_numbered_test_file(test, line_count));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, READ_FILE_CONTIGUOUS));
+    CHECK_NUMBERED_LINES(test, line_count);
+    read_file_delete_null(&test->rf);
+
+    /* Allocations grow with the log of the size, and any may fail. */
+    for (successes = 0; NULL == test->rf; ++successes) {
+        CUT_ASSERT(successes < 24);
+        mallmock_set_any_alloc_return(NULL, successes);
+        test->rf = read_file_new_with_flags(test->filename, READ_FILE_CONTIGUOUS);
+    }
+    mallmock_reset();
+    CHECK_NUMBERED_LINES(test, line_count);
+    CUT_TEST_PASS();
+}   /* test_read_file_contiguous() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Check that line @p n of @p test->rf, as a view, is @p expected.
+ */
+static cut_result_t check_line_view(const char *file, int line, test_t *test, size_t n, const char *expected) {
+    const char *view = NULL;
+    size_t size = 0;
+
+    CUT_FL_ASSERT_NOT_NULL(file, line, view = read_file_get_line_view(test->rf, n, &size));
+    CUT_FL_ASSERT_INT(file, line, strlen(expected), size);
+    CUT_FL_ASSERT(file, line, 0 == memcmp(expected, view, size));
+    return CUT_RESULT_PASS;
+}   /* check_line_view() */
+
+#define CHECK_LINE_VIEW(_test,_n,_expected) CUT_RETURN(check_line_view(__FILE__, __LINE__, (_test), (_n), (_expected)))
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_mmap(test_t *test) {
+    const unsigned int flags[] = { 0, READ_FILE_CONTIGUOUS, READ_FILE_MMAP };
+    size_t size = 1;
+    size_t i = 0;
+
+    CUT_RETURN(create_test_file(test, ""));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_mmap(test->filename));
+    CUT_ASSERT_INT(0, read_file_get_line_count(test->rf));
+    CUT_ASSERT_NULL(read_file_get_line_view(test->rf, 0, &size));
+    CUT_ASSERT_INT(0, size);
+
+    CUT_RETURN(create_test_file(test, "first\n\nlast"));
+    for (i = 0; i < sizeof(flags) / sizeof(flags[0]); ++i) {
+        read_file_delete_null(&test->rf);
+        CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags[i]));
+        CUT_ASSERT_INT(3, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 0, "first\n");
+        CHECK_LINE_VIEW(test, 1, "\n");
+        CHECK_LINE_VIEW(test, 2, "last");
+        CUT_ASSERT_NULL(read_file_get_line_view(test->rf, 3, NULL));
+    }
+    CUT_ASSERT_NULL(read_file_get_line(test->rf, 0));
+
+    CUT_RETURN(create_numbered_test_file(test, 20000));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_mmap(test->filename));
+    CUT_ASSERT_INT(20000, read_file_get_line_count(test->rf));
+    CHECK_LINE_VIEW(test, 0, "line 0\n");
+    CHECK_LINE_VIEW(test, 12345, "line 12345\n");
+    CHECK_LINE_VIEW(test, 19999, "line 19999\n");
+    CUT_TEST_PASS();
+}   /* test_read_file_mmap() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_long_lines(test_t *test) {
+    const unsigned int flags[] = { 0, READ_FILE_CONTIGUOUS, READ_FILE_ASYNC };
+    const size_t long_size = 3000000;   /* Several times the initial buffer. */
+    char *contents = NULL;
+    const char *line = NULL;
+    size_t size = 0;
+    size_t i = 0;
+
+    CUT_ASSERT_NOT_NULL(contents = malloc(long_size + 16));
+    strcpy(contents, "short\n");
+    memset(&contents[6], 'y', long_size - 1);
+    strcpy(&contents[6 + long_size - 1], "\nend");
+    CUT_RETURN(create_test_file(test, contents));
+    free(contents);
+    for (i = 0; i < sizeof(flags) / sizeof(flags[0]); ++i) {
+        read_file_delete_null(&test->rf);
+        CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags[i]));
+        CUT_ASSERT_INT(3, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 0, "short\n");
+        CUT_ASSERT_NOT_NULL(line = read_file_get_line_view(test->rf, 1, &size));
+        CUT_ASSERT_INT(long_size, size);
+        CUT_ASSERT_INT('y', line[0]);
+        CUT_ASSERT_INT('\n', line[long_size - 1]);
+        CHECK_LINE_VIEW(test, 2, "end");
+    }
+
+    /* A buffer that can't grow fails the load rather than split a line. */
+    CUT_ASSERT_NOT_NULL(contents = malloc(5000 + 16));
+    memset(contents, 'y', 4999);
+    strcpy(&contents[4999], "\nshort\nend");
+    CUT_RETURN(create_test_file(test, contents));
+    free(contents);
+    for (i = 0; NULL == test->rf; ++i) {
+        CUT_ASSERT(i < 20);
+        mallmock_set_any_alloc_return(NULL, i);
+        test->rf = read_file_new(test->filename);
+        mallmock_reset();
+    }
+    CUT_ASSERT_INT(3, read_file_get_line_count(test->rf));
+    CUT_ASSERT_NOT_NULL(line = read_file_get_line_view(test->rf, 0, &size));
+    CUT_ASSERT_INT(5000, size);
+    CHECK_LINE_VIEW(test, 1, "short\n");
+#if defined(SPIN_LOCK_STATS)
+    if (cut_print_case_flags & CUT_FLAG_PASS) {
+        mallmock_dump_lock_stats(stdout);
+    }
+#endif
+    CUT_TEST_PASS();
+}   /* test_read_file_long_lines() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_cursor(test_t *test) {
+    read_file_cursor_t *cursor = NULL;
+    char *long_line = NULL;
+    char expected[32];
+    const char *line = NULL;
+    size_t size = 0;
+    size_t n = 0;
+
+    CUT_ASSERT_NULL(read_file_cursor_open(NULL));
+    CUT_ASSERT_NULL(read_file_cursor_open("/etc/bob/some/file/that/does/not/exist"));
+    CUT_ASSERT_NULL(read_file_cursor_next(NULL, &size));
+    read_file_cursor_close(NULL);
+
+    CUT_RETURN(create_test_file(test, "first\n\nlast"));
+    mallmock_set_any_alloc_return(NULL, 0);
+    CUT_ASSERT_NULL(read_file_cursor_open(test->filename));
+    mallmock_reset();
+    CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open(test->filename));
+    CUT_ASSERT_STRING("first\n", read_file_cursor_next(cursor, &size));
+    CUT_ASSERT_INT(6, size);
+    CUT_ASSERT_STRING("\n", read_file_cursor_next(cursor, &size));
+    CUT_ASSERT_INT(1, size);
+    CUT_ASSERT_STRING("last", read_file_cursor_next(cursor, NULL));
+    CUT_ASSERT_NULL(read_file_cursor_next(cursor, &size));
+    CUT_ASSERT_NULL(read_file_cursor_next(cursor, &size));
+    CUT_ASSERT(!read_file_cursor_error(cursor));
+    read_file_cursor_close(cursor);
+
+    /* Nothing is allocated per line. */
+    CUT_RETURN(create_numbered_test_file(test, 20000));
+    CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open(test->filename));
+    mallmock_set_any_alloc_return(NULL, 0);
+    for (n = 0; NULL != (line = read_file_cursor_next(cursor, &size)); ++n) {
+        sprintf(expected, "line %zu\n", n);
+        CUT_ASSERT_STRING(expected, line);
+        CUT_ASSERT_INT(strlen(expected), size);
+    }
+    mallmock_reset();
+    CUT_ASSERT_INT(20000, n);
+    read_file_cursor_close(cursor);
+
+    /* Lines longer than the buffer grow it. */
+    CUT_ASSERT_NOT_NULL(long_line = malloc(200000));
+    memset(long_line, 'x', 199998);
+    long_line[199998] = '\n';
+    long_line[199999] = 0;
+    CUT_RETURN(create_test_file(test, long_line));
+    free(long_line);
+    CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open(test->filename));
+    CUT_ASSERT_NOT_NULL(line = read_file_cursor_next(cursor, &size));
+    CUT_ASSERT_INT(199999, size);
+    CUT_ASSERT_INT(199999, strspn(line, "x") + 1);
+    CUT_ASSERT_NULL(read_file_cursor_next(cursor, &size));
+    read_file_cursor_close(cursor);
+
+    /* If the buffer can't grow, they come out in pieces. */
+    CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open(test->filename));
+    mallmock_set_any_alloc_return(NULL, 0);
+    CUT_ASSERT_NOT_NULL(read_file_cursor_next(cursor, &size));
+    mallmock_reset();
+    CUT_ASSERT(size < 199999);
+    for (n = size; NULL != read_file_cursor_next(cursor, &size); n += size) {
+        CUT_ASSERT(size > 0);
+    }
+    CUT_ASSERT_INT(199999, n);
+    read_file_cursor_close(cursor);
+    CUT_TEST_PASS();
+}   /* test_read_file_cursor() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_async(test_t *test) {
+    const size_t line_count = 300000;     /* Several async buffers' worth. */
+    read_file_cursor_t *cursor = NULL;
+    char expected[32];
+    const char *line = NULL;
+    size_t n = 0;
+
+    CUT_RETURN(create_test_file(test, ""));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, READ_FILE_ASYNC));
+    CUT_ASSERT_INT(0, read_file_get_line_count(test->rf));
+
+    CUT_RETURN(create_numbered_test_file(test, line_count));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, READ_FILE_ASYNC));
+    CHECK_NUMBERED_LINES(test, line_count);
+    read_file_delete_null(&test->rf);
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, READ_FILE_ASYNC | READ_FILE_CONTIGUOUS));
+    CHECK_NUMBERED_LINES(test, line_count);
+
+    CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open_with_flags(test->filename, READ_FILE_ASYNC));
+    for (n = 0; NULL != (line = read_file_cursor_next(cursor, NULL)); ++n) {
+        sprintf(expected, "line %zu\n", n);
+        CUT_ASSERT_STRING(expected, line);
+    }
+    CUT_ASSERT(!read_file_cursor_error(cursor));
+    CUT_ASSERT_INT(line_count, n);
+    read_file_cursor_close(cursor);
+
+    /* Closing early stops the reader. */
+    CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open_with_flags(test->filename, READ_FILE_ASYNC));
+    CUT_ASSERT_STRING("line 0\n", read_file_cursor_next(cursor, NULL));
+    read_file_cursor_close(cursor);
+
+    mallmock_set_any_alloc_return(NULL, 1);
+    CUT_ASSERT_NULL(read_file_cursor_open_with_flags(test->filename, READ_FILE_ASYNC));
+    CUT_TEST_PASS();
+}   /* test_read_file_async() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_parallel(test_t *test) {
+    const size_t line_count = 300000;     /* Enough for many ranges. */
+    const int thread_counts[] = { 1, 2, 3, 8, 0 };
+    size_t i = 0;
+
+    CUT_ASSERT_NULL(read_file_new_parallel(NULL, 2));
+    CUT_ASSERT_NULL(read_file_new_parallel("/etc/bob/some/file/that/does/not/exist", 2));
+
+    CUT_RETURN(create_test_file(test, ""));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_parallel(test->filename, 4));
+    CUT_ASSERT_INT(0, read_file_get_line_count(test->rf));
+
+    CUT_RETURN(create_test_file(test, "first\n\nlast"));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_parallel(test->filename, 4));
+    CUT_ASSERT_INT(3, read_file_get_line_count(test->rf));
+    CUT_ASSERT_STRING("first\n", read_file_get_line(test->rf, 0));
+    CUT_ASSERT_STRING("\n", read_file_get_line(test->rf, 1));
+    CUT_ASSERT_STRING("last", read_file_get_line(test->rf, 2));
+    CHECK_LINE_VIEW(test, 2, "last");
+
+    CUT_RETURN(create_numbered_test_file(test, line_count));
+    for (i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); ++i) {
+        read_file_delete_null(&test->rf);
+        CUT_ASSERT_NOT_NULL(test->rf = read_file_new_parallel(test->filename, thread_counts[i]));
+        CHECK_NUMBERED_LINES(test, line_count);
+    }
+
+    /* The rf object, its filename, the ranges, the thread flags, then the line data. */
+    read_file_delete_null(&test->rf);
+    mallmock_set_any_alloc_return(NULL, 4);
+    CUT_ASSERT_NULL(test->rf = read_file_new_parallel(test->filename, 2));
+
+    /* Without the thread flags, everything runs on this thread. */
+    mallmock_set_any_alloc_return(NULL, 3);
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_parallel(test->filename, 2));
+    mallmock_reset();
+    CHECK_NUMBERED_LINES(test, line_count);
+    CUT_TEST_PASS();
+}   /* test_read_file_parallel() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Append @p size bytes at @p contents to the test file, as a log writer
+ * would.
+ */
+static cut_result_t append_test_bytes(test_t *test, const char *contents, size_t size) {
+    int fd = open(test->filename, O_WRONLY | O_APPEND);
+    if (fd < 0) {
+        return CUT_RESULT_ERROR;
+    }
+    if (write(fd, contents, size) != (ssize_t) size) {
+        close(fd);
+        return CUT_RESULT_ERROR;
+    }
+    close(fd);
+    return CUT_RESULT_PASS;
+}   /* append_test_bytes() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Append the string @p contents to the test file.
+ */
+static cut_result_t append_test_file(test_t *test, const char *contents) {
+    return append_test_bytes(test, contents, strlen(contents));
+}   /* append_test_file() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_batch(test_t *test) {
+    const int thread_counts[] = { 1, 3, 0 };
+    const char *contents[] = { "first\n\nlast", "", "one\n", "a\nb\n" };
+    char filenames[4][sizeof(test->filename)];
+    const char *paths[6];
+    read_file_batch_t *batch = NULL;
+    read_file_t *rf = NULL;
+    size_t i = 0;
+
+    CUT_ASSERT_NULL(read_file_load_batch(NULL, 1, 2));
+    CUT_ASSERT_NOT_NULL(batch = read_file_load_batch(NULL, 0, 2));
+    CUT_ASSERT_INT(0, read_file_batch_count(batch));
+    CUT_ASSERT_NULL(read_file_batch_get(batch, 0));
+    read_file_batch_delete(batch);
+    read_file_batch_delete(NULL);
+
+    /* Keep the files around; create_test_file() removes the last one. */
+    for (i = 0; i < 4; ++i) {
+        CUT_RETURN(create_test_file(test, contents[i]));
+        strcpy(filenames[i], test->filename);
+        test->filename[0] = 0;
+    }
+    CUT_RETURN(create_numbered_test_file(test, 100000));
+    paths[0] = filenames[0];
+    paths[1] = filenames[1];
+    paths[2] = "/etc/bob/some/file/that/does/not/exist";
+    paths[3] = filenames[2];
+    paths[4] = test->filename;
+    paths[5] = filenames[3];
+
+    for (i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); ++i) {
+        CUT_ASSERT_NOT_NULL(batch = read_file_load_batch(paths, 6, thread_counts[i]));
+        CUT_ASSERT_INT(6, read_file_batch_count(batch));
+        CUT_ASSERT_NOT_NULL(rf = read_file_batch_get(batch, 0));
+        CUT_ASSERT_STRING(filenames[0], read_file_get_filename(rf));
+        CUT_ASSERT_INT(3, read_file_get_line_count(rf));
+        CUT_ASSERT_STRING("first\n", read_file_get_line(rf, 0));
+        CUT_ASSERT_STRING("\n", read_file_get_line(rf, 1));
+        CUT_ASSERT_STRING("last", read_file_get_line(rf, 2));
+        CUT_ASSERT_NOT_NULL(rf = read_file_batch_get(batch, 1));
+        CUT_ASSERT_INT(0, read_file_get_line_count(rf));
+        CUT_ASSERT_NULL(read_file_batch_get(batch, 2));
+        CUT_ASSERT_NOT_NULL(rf = read_file_batch_get(batch, 3));
+        CUT_ASSERT_INT(1, read_file_get_line_count(rf));
+        CUT_ASSERT_STRING("one\n", read_file_get_line(rf, 0));
+        CUT_ASSERT_NOT_NULL(rf = read_file_batch_get(batch, 5));
+        CUT_ASSERT_INT(2, read_file_get_line_count(rf));
+        CUT_ASSERT_STRING("b\n", read_file_get_line(rf, 1));
+        CUT_ASSERT(!read_file_refresh(rf));
+        read_file_delete(rf);   /* Ignored. */
+        CUT_ASSERT_NULL(read_file_batch_get(batch, 6));
+
+        /* The big one, through the usual checks. */
+        test->rf = read_file_batch_get(batch, 4);
+        CHECK_NUMBERED_LINES(test, 100000);
+        test->rf = NULL;
+        read_file_batch_delete(batch);
+    }
+
+    mallmock_set_any_alloc_return(NULL, 0);
+    CUT_ASSERT_NULL(read_file_load_batch(paths, 6, 2));
+    mallmock_set_any_alloc_return(NULL, 1);
+    CUT_ASSERT_NULL(read_file_load_batch(paths, 6, 2));
+    mallmock_reset();
+
+    for (i = 0; i < 4; ++i) {
+        unlink(filenames[i]);
+    }
+    CUT_TEST_PASS();
+}   /* test_read_file_batch() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_refresh(test_t *test) {
+    const unsigned int flags[] = { 0, READ_FILE_CONTIGUOUS, READ_FILE_MMAP };
+    char filename[sizeof(test->filename)];
+    read_file_t *rf = NULL;
+    const char *line = NULL;
+    size_t size = 0;
+    size_t i = 0;
+
+    CUT_ASSERT(!read_file_refresh(NULL));
+    for (i = 0; i < sizeof(flags) / sizeof(flags[0]); ++i) {
+        CUT_RETURN(create_test_file(test, "one\ntw"));
+        CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags[i]));
+        CUT_ASSERT_INT(2, read_file_get_line_count(test->rf));
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_INT(2, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 1, "tw");
+
+        /* The partial last line is completed, and more lines follow. */
+        CUT_RETURN(append_test_file(test, "o\nthree\nfo"));
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_INT(4, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 0, "one\n");
+        CHECK_LINE_VIEW(test, 1, "two\n");
+        CHECK_LINE_VIEW(test, 2, "three\n");
+        CHECK_LINE_VIEW(test, 3, "fo");
+        CUT_RETURN(append_test_file(test, "ur\n"));
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_INT(4, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 3, "four\n");
+
+        /* Truncated, then rewritten. */
+        CUT_ASSERT_INT(0, truncate(test->filename, 0));
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_INT(0, read_file_get_line_count(test->rf));
+        CUT_RETURN(append_test_file(test, "five\n"));
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_INT(1, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 0, "five\n");
+
+        /* Rotated: a new file of the same name, even if it is bigger. */
+        strcpy(filename, test->filename);
+        test->filename[0] = 0;
+        rf = test->rf;
+        test->rf = NULL;
+        CUT_RETURN(create_test_file(test, "six\nseven\n"));
+        test->rf = rf;
+        CUT_ASSERT_INT(0, rename(test->filename, filename));
+        strcpy(test->filename, filename);
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_STRING(filename, read_file_get_filename(test->rf));
+        CUT_ASSERT_INT(2, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 0, "six\n");
+        CHECK_LINE_VIEW(test, 1, "seven\n");
+        CUT_RETURN(append_test_file(test, "eight\n"));
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_INT(3, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 2, "eight\n");
+
+        /* Gone. */
+        unlink(test->filename);
+        CUT_ASSERT(!read_file_refresh(test->rf));
+        CUT_ASSERT_INT(3, read_file_get_line_count(test->rf));
+        clear_test_data(test);
+    }
+
+    /* A partial line holding a NUL is re-read from its start. */
+    CUT_RETURN(create_test_file(test, "one\n"));
+    CUT_RETURN(append_test_bytes(test, "t\0w", 3));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new(test->filename));
+    CUT_ASSERT_NOT_NULL(line = read_file_get_line_view(test->rf, 1, &size));
+    CUT_ASSERT_INT(3, size);
+    CUT_RETURN(append_test_file(test, "o\n"));
+    CUT_ASSERT(read_file_refresh(test->rf));
+    CUT_ASSERT_INT(2, read_file_get_line_count(test->rf));
+    CUT_ASSERT_NOT_NULL(line = read_file_get_line_view(test->rf, 1, &size));
+    CUT_ASSERT_INT(5, size);
+    CUT_ASSERT(0 == memcmp("t\0wo\n", line, 5));
+    CUT_TEST_PASS();
+}   /* test_read_file_refresh() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_refresh_remap_failure(test_t *test) {
+    const size_t big_size = 0x800000;   /* Well past the address space left. */
+    struct rlimit old_limit;
+    struct rlimit limit;
+    unsigned long pages = 0;
+    char *big = NULL;
+    FILE *file = NULL;
+    int ok = 0;
+
+    CUT_RETURN(create_test_file(test, "one\ntwo\n"));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_mmap(test->filename));
+    CUT_ASSERT_NOT_NULL(big = malloc(big_size));
+    memset(big, 'z', big_size);
+    big[big_size - 1] = '\n';
+    CUT_RETURN(append_test_bytes(test, big, big_size));
+    free(big);
+
+    /* Leave no room for mapping the bigger file. */
+    file = fopen("/proc/self/statm", "r");
+    if ((NULL == file) || (1 != fscanf(file, "%lu", &pages)) || (0 != getrlimit(RLIMIT_AS, &old_limit))) {
+        if (NULL != file) {
+            fclose(file);
+        }
+        CUT_TEST_SKIP();
+    }
+    fclose(file);
+    limit = old_limit;
+    limit.rlim_cur = (rlim_t) pages * sysconf(_SC_PAGESIZE) + 0x100000;
+    CUT_ASSERT_INT(0, setrlimit(RLIMIT_AS, &limit));
+    ok = read_file_refresh(test->rf);
+    setrlimit(RLIMIT_AS, &old_limit);
+
+    CUT_ASSERT(!ok);
+    CUT_ASSERT_INT(2, read_file_get_line_count(test->rf));
+    CHECK_LINE_VIEW(test, 0, "one\n");
+    CHECK_LINE_VIEW(test, 1, "two\n");
+    CUT_ASSERT(read_file_refresh(test->rf));
+    CUT_ASSERT_INT(3, read_file_get_line_count(test->rf));
+    CHECK_LINE_VIEW(test, 1, "two\n");
+    CUT_TEST_PASS();
+}   /* test_read_file_refresh_remap_failure() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Check the first @p line_count lines of a mapped numbered test file, as
+ * views since mapped lines aren't NUL-terminated.
+ */
+static cut_result_t check_numbered_line_views(const char *file, int line, test_t *test, size_t line_count) {
+    char expected[32];
+    size_t i = 0;
+
+    for (i = line_count; i-- > 0; ) {
+        sprintf(expected, "line %zu\n", i);
+        CUT_RETURN(check_line_view(file, line, test, i, expected));
+    }
+    return CUT_RESULT_PASS;
+}   /* check_numbered_line_views() */
+
+#define CHECK_NUMBERED_LINE_VIEWS(_test,_count) \
+    CUT_RETURN(check_numbered_line_views(__FILE__, __LINE__, (_test), (_count)))
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_sidecar(test_t *test) {
+    const unsigned int flags = READ_FILE_MMAP | READ_FILE_SIDECAR_INDEX;
+    const size_t line_count = 1000;    /* Many checkpoints, and not a multiple of them. */
+    char sidecar[sizeof(test->filename) + 8];
+    struct timespec times[2];
+    struct stat st;
+    mode_t old_mask = 0;
+    size_t size = 0;
+    FILE *file = NULL;
+
+    CUT_RETURN(create_numbered_test_file(test, line_count));
+    CUT_RETURN(append_test_file(test, "no newline"));
+    sprintf(sidecar, "%s.lidx", test->filename);
+    unlink(sidecar);
+
+    /* Without the flag there is no sidecar. */
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_mmap(test->filename));
+    CUT_ASSERT(0 != access(sidecar, F_OK));
+    read_file_delete_null(&test->rf);
+
+    /* The first open writes it, as the umask allows, the second uses it. */
+    old_mask = umask(027);
+    test->rf = read_file_new_with_flags(test->filename, flags);
+    umask(old_mask);
+    CUT_ASSERT_NOT_NULL(test->rf);
+    CUT_ASSERT_INT(0, stat(sidecar, &st));
+    CUT_ASSERT_INT(0640, st.st_mode & 0777);
+    CHECK_NUMBERED_LINE_VIEWS(test, line_count);
+    CHECK_LINE_VIEW(test, line_count, "no newline");
+    read_file_delete_null(&test->rf);
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags));
+    CUT_ASSERT_INT(line_count + 1, read_file_get_line_count(test->rf));
+    CHECK_NUMBERED_LINE_VIEWS(test, line_count);
+    CHECK_LINE_VIEW(test, line_count, "no newline");
+    CUT_ASSERT_NULL(read_file_get_line_view(test->rf, line_count + 1, &size));
+
+    /* Growing moves to plain offsets. */
+    CUT_RETURN(append_test_file(test, "\nmore\n"));
+    CUT_ASSERT(read_file_refresh(test->rf));
+    CUT_ASSERT_INT(line_count + 2, read_file_get_line_count(test->rf));
+    CHECK_NUMBERED_LINE_VIEWS(test, line_count);
+    CHECK_LINE_VIEW(test, line_count, "no newline\n");
+    CHECK_LINE_VIEW(test, line_count + 1, "more\n");
+    read_file_delete_null(&test->rf);
+
+    /*
+     * Rewritten in place with the same size and time, the file still
+     * matches its (new) sidecar, which is trusted, so line 0 keeps its old
+     * length. Any other time and the file is scanned again.
+     */
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags));
+    read_file_delete_null(&test->rf);
+    CUT_ASSERT_INT(0, stat(test->filename, &st));
+    CUT_ASSERT_NOT_NULL(file = fopen(test->filename, "r+"));
+    fputs("line\n0\n", file);
+    fclose(file);
+    times[0].tv_sec = st.st_atime;
+    times[0].tv_nsec = 0;
+    times[1] = st.st_mtim;
+    CUT_ASSERT_INT(0, utimensat(AT_FDCWD, test->filename, times, 0));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags));
+    CUT_ASSERT_NOT_NULL(read_file_get_line_view(test->rf, 0, &size));
+    CUT_ASSERT_INT(7, size);
+    read_file_delete_null(&test->rf);
+    times[1].tv_sec++;
+    CUT_ASSERT_INT(0, utimensat(AT_FDCWD, test->filename, times, 0));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags));
+    CUT_ASSERT_INT(line_count + 3, read_file_get_line_count(test->rf));
+    CHECK_LINE_VIEW(test, 0, "line\n");
+    CHECK_LINE_VIEW(test, 1, "0\n");
+    read_file_delete_null(&test->rf);
+
+    /* A damaged sidecar is ignored, and replaced. */
+    CUT_ASSERT_INT(0, truncate(sidecar, 100));
+    CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags));
+    CUT_ASSERT_INT(line_count + 3, read_file_get_line_count(test->rf));
+    CHECK_LINE_VIEW(test, 1, "0\n");
+    CUT_ASSERT_INT(0, stat(sidecar, &st));
+    CUT_ASSERT(st.st_size > 100);
+    unlink(sidecar);
+    CUT_TEST_PASS();
+}   /* test_read_file_sidecar() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_sidecar_no_room(test_t *test) {
+    const size_t line_count = 1000;
+    char pattern[sizeof(test->filename) + 8];
+    struct rlimit old_limit;
+    struct rlimit limit;
+    void (*old_handler)(int) = SIG_DFL;
+    glob_t found;
+
+    CUT_RETURN(create_numbered_test_file(test, line_count));
+    sprintf(pattern, "%s.lidx*", test->filename);
+    CUT_ASSERT_INT(0, getrlimit(RLIMIT_FSIZE, &old_limit));
+
+    /* Too small for the sidecar, whose writes then fail part way. */
+    limit = old_limit;
+    limit.rlim_cur = 0x200;
+    old_handler = signal(SIGXFSZ, SIG_IGN);
+    CUT_ASSERT_INT(0, setrlimit(RLIMIT_FSIZE, &limit));
+    test->rf = read_file_new_with_flags(test->filename, READ_FILE_MMAP | READ_FILE_SIDECAR_INDEX);
+    setrlimit(RLIMIT_FSIZE, &old_limit);
+    signal(SIGXFSZ, old_handler);
+
+    /* The file still loads, and neither a sidecar nor a temporary is left. */
+    CUT_ASSERT_NOT_NULL(test->rf);
+    CUT_ASSERT_INT(line_count, read_file_get_line_count(test->rf));
+    CHECK_NUMBERED_LINE_VIEWS(test, line_count);
+    CUT_ASSERT_INT(GLOB_NOMATCH, glob(pattern, 0, NULL, &found));
+    CUT_TEST_PASS();
+}   /* test_read_file_sidecar_no_room() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Replace the test file with its contents compressed as @p format, "gzip"
+ * or "zstd". Gzip files are written as two members, as if concatenated.
+ */
+static cut_result_t compress_test_file(test_t *test, const char *format) {
+    cut_result_t result = CUT_RESULT_ERROR;
+    char *contents = NULL;
+    size_t size = 0;
+    FILE *file = fopen(test->filename, "rb");
+
+    if (NULL == file) {
+        return CUT_RESULT_ERROR;
+    }
+    fseek(file, 0, SEEK_END);
+    size = (size_t) ftell(file);
+    rewind(file);
+    contents = malloc(size + 1);
+    if ((NULL == contents) || (fread(contents, 1, size, file) != size)) {
+        fclose(file);
+        free(contents);
+        return CUT_RESULT_ERROR;
+    }
+    fclose(file);
+#ifdef READ_FILE_ZLIB
+    if (0 == strcmp(format, "gzip")) {
+        gzFile gz = gzopen(test->filename, "wb");
+        if ((NULL != gz) && (gzwrite(gz, contents, size / 2) == (int) (size / 2)) && (Z_OK == gzclose(gz)) &&
+            (NULL != (gz = gzopen(test->filename, "ab"))) &&
+            (gzwrite(gz, &contents[size / 2], size - size / 2) == (int) (size - size / 2)) && (Z_OK == gzclose(gz))) {
+            result = CUT_RESULT_PASS;
+        }
+    }
+#endif
+#ifdef READ_FILE_ZSTD
+    if (0 == strcmp(format, "zstd")) {
+        size_t bound = ZSTD_compressBound(size);
+        char *compressed = malloc(bound);
+        if (NULL != compressed) {
+            size_t compressed_size = ZSTD_compress(compressed, bound, contents, size, 3);
+            if (!ZSTD_isError(compressed_size) && (NULL != (file = fopen(test->filename, "wb")))) {
+                if (fwrite(compressed, 1, compressed_size, file) == compressed_size) {
+                    result = CUT_RESULT_PASS;
+                }
+                fclose(file);
+            }
+            free(compressed);
+        }
+    }
+#endif
+    free(contents);
+    return result;
+}   /* compress_test_file() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_read_file_compressed(test_t *test) {
+    const unsigned int flags[] = { 0, READ_FILE_CONTIGUOUS, READ_FILE_MMAP, READ_FILE_ASYNC };
+    const char *formats[] = {
+#ifdef READ_FILE_ZLIB
+        "gzip",
+#endif
+#ifdef READ_FILE_ZSTD
+        "zstd",
+#endif
+        NULL
+    };
+    const size_t line_count = 50000;
+    read_file_cursor_t *cursor = NULL;
+    read_file_batch_t *batch = NULL;
+    const char *paths[1];
+    const char *appended = NULL;
+    char expected[32];
+    const char *line = NULL;
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+
+    if (NULL == formats[0]) {
+        CUT_TEST_SKIP();        /* Built without "make ZLIB=1" or "make ZSTD=1". */
+    }
+    for (i = 0; NULL != formats[i]; ++i) {
+        /* Bytes appended to a plain file are plain, even if they look compressed. */
+        appended = (0 == strcmp(formats[i], "gzip")) ? "\x1f\x8b\x08 more\n" : "\x28\xb5\x2f\xfd more\n";
+        CUT_RETURN(create_test_file(test, "plain\n"));
+        CUT_ASSERT_NOT_NULL(test->rf = read_file_new(test->filename));
+        CUT_RETURN(append_test_file(test, appended));
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CUT_ASSERT_INT(2, read_file_get_line_count(test->rf));
+        CHECK_LINE_VIEW(test, 1, appended);
+
+        CUT_RETURN(create_numbered_test_file(test, line_count));
+        CUT_RETURN(compress_test_file(test, formats[i]));
+        for (j = 0; j < sizeof(flags) / sizeof(flags[0]); ++j) {
+            read_file_delete_null(&test->rf);
+            CUT_ASSERT_NOT_NULL(test->rf = read_file_new_with_flags(test->filename, flags[j]));
+            CHECK_NUMBERED_LINES(test, line_count);
+        }
+        read_file_delete_null(&test->rf);
+        CUT_ASSERT_NOT_NULL(test->rf = read_file_new_parallel(test->filename, 2));
+        CHECK_NUMBERED_LINES(test, line_count);
+        CUT_ASSERT(read_file_refresh(test->rf));
+        CHECK_NUMBERED_LINES(test, line_count);
+        read_file_delete_null(&test->rf);
+
+        paths[0] = test->filename;
+        CUT_ASSERT_NOT_NULL(batch = read_file_load_batch(paths, 1, 1));
+        test->rf = read_file_batch_get(batch, 0);
+        CHECK_NUMBERED_LINES(test, line_count);
+        test->rf = NULL;
+        read_file_batch_delete(batch);
+
+        CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open(test->filename));
+        for (n = 0; NULL != (line = read_file_cursor_next(cursor, NULL)); ++n) {
+            sprintf(expected, "line %zu\n", n);
+            CUT_ASSERT_STRING(expected, line);
+        }
+        CUT_ASSERT(!read_file_cursor_error(cursor));
+        read_file_cursor_close(cursor);
+        CUT_ASSERT_INT(line_count, n);
+
+        /* Cut short, which is an error rather than the end. */
+        CUT_ASSERT_INT(0, truncate(test->filename, 100));
+        CUT_ASSERT_NULL(test->rf = read_file_new(test->filename));
+        CUT_ASSERT_NOT_NULL(cursor = read_file_cursor_open(test->filename));
+        while (NULL != read_file_cursor_next(cursor, NULL)) {
+        }
+        CUT_ASSERT(read_file_cursor_error(cursor));
+        read_file_cursor_close(cursor);
+    }
+    CUT_TEST_PASS();
+}   /* test_read_file_compressed() */
+
 /* ------------------------------------------------------------------------- */
 void test_read_file(void) {
     CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
     CUT_ADD_TEST(test_read_file_degenerate);
     CUT_ADD_TEST(test_read_file_simple);
     CUT_ADD_TEST(test_read_file_low_memory);
+    CUT_ADD_TEST(test_read_file_many_lines);
+    CUT_ADD_TEST(test_read_file_contiguous);
+    CUT_ADD_TEST(test_read_file_mmap);
+    CUT_ADD_TEST(test_read_file_long_lines);
+    CUT_ADD_TEST(test_read_file_cursor);
+    CUT_ADD_TEST(test_read_file_async);
+    CUT_ADD_TEST(test_read_file_parallel);
+    CUT_ADD_TEST(test_read_file_batch);
+    CUT_ADD_TEST(test_read_file_refresh);
+    CUT_ADD_TEST(test_read_file_refresh_remap_failure);
+    CUT_ADD_TEST(test_read_file_sidecar);
+    CUT_ADD_TEST(test_read_file_sidecar_no_room);
+    CUT_ADD_TEST(test_read_file_compressed);
 }   /* test_read_file() */
 
 /* ------------------------------------------------------------------------- */
@@ -0,0 +1,190 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#ifndef MALLMOCK_REL_LIST_H_
+#define MALLMOCK_REL_LIST_H_
+
+/*
+ * Relocatable doubly linked list functions.
+ *
+ * These mirror the list_t functions in link_list.h, but each link holds
+ * 32-bit byte offsets from itself to its neighbours rather than pointers.
+ * A list built inside one block of memory therefore stays valid when that
+ * block is copied, written to a file and mapped back in, or shared between
+ * processes that map it at different addresses. Each link is half the size
+ * of a link_t on 64-bit targets.
+ *
+ * All links of a list must lie within 2 GiB of each other.
+ */
+#include <assert.h>
+#include <stdlib.h>     /* sadly, for NULL. */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "link_list.h"  /* For STRUCT_CONTAINING_LINK(). */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct rel_link_s rel_link_t;
+
+struct rel_link_s {
+    int32_t next;   /**< Offset in bytes from this link to the next one. */
+    int32_t prev;   /**< Offset in bytes from this link to the previous one. */
+};
+
+static inline rel_link_t* rel_link_next(rel_link_t* link) {
+    return (rel_link_t*) ((char*) link + link->next);
+}   /* rel_link_next() */
+
+static inline rel_link_t* rel_link_prev(rel_link_t* link) {
+    return (rel_link_t*) ((char*) link + link->prev);
+}   /* rel_link_prev() */
+
+/**
+ * @return the offset from @p from to @p to.
+ */
+static inline int32_t rel_link_offset(rel_link_t* from, rel_link_t* to) {
+    ptrdiff_t offset = (char*) to - (char*) from;
+    assert((offset >= INT32_MIN) && (offset <= INT32_MAX));
+    return (int32_t) offset;
+}   /* rel_link_offset() */
+
+static inline void rel_link_set_next(rel_link_t* link, rel_link_t* next) {
+    link->next = rel_link_offset(link, next);
+}   /* rel_link_set_next() */
+
+static inline void rel_link_set_prev(rel_link_t* link, rel_link_t* prev) {
+    link->prev = rel_link_offset(link, prev);
+}   /* rel_link_set_prev() */
+
+static inline rel_link_t* rel_link_insert_prev(rel_link_t* base_link, rel_link_t* new_link) {
+    rel_link_t* prev = rel_link_prev(base_link);
+    rel_link_set_prev(new_link, prev);
+    rel_link_set_next(new_link, base_link);
+    rel_link_set_next(prev, new_link);
+    rel_link_set_prev(base_link, new_link);
+    return new_link;
+}   /* rel_link_insert_prev() */
+
+static inline rel_link_t* rel_link_insert_next(rel_link_t* base_link, rel_link_t* new_link) {
+    rel_link_t* next = rel_link_next(base_link);
+    rel_link_set_next(new_link, next);
+    rel_link_set_prev(new_link, base_link);
+    rel_link_set_prev(next, new_link);
+    rel_link_set_next(base_link, new_link);
+    return new_link;
+}   /* rel_link_insert_next() */
+
+static inline rel_link_t* rel_link_remove(rel_link_t* link) {
+    rel_link_t* prev = rel_link_prev(link);
+    rel_link_t* next = rel_link_next(link);
+    rel_link_set_next(prev, next);
+    rel_link_set_prev(next, prev);
+    link->prev = 0;
+    link->next = 0;
+    return link;
+}   /* rel_link_remove() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * As with list_t, a list is just a link that's used as an anchor.
+ */
+typedef rel_link_t rel_list_t;
+
+/**
+ * Intended usage:
+ *
+ *    rel_list_t REL_LIST_INIT(g_my_list);
+ *
+ * An all-zero rel_list_t is also a valid empty list.
+ */
+#define REL_LIST_INIT(_variable_name) _variable_name = { 0, 0 }
+
+static inline rel_list_t* rel_list_init(rel_list_t* list) {
+    list->prev = 0;
+    list->next = 0;
+    return list;
+}   /* rel_list_init() */
+
+static inline int rel_list_empty(rel_list_t* list) {
+    return 0 == list->next;
+}   /* rel_list_empty() */
+
+static inline rel_link_t* rel_list_insert_prev(rel_list_t* list, rel_link_t* link) {
+    return rel_link_insert_prev(list, link);
+}   /* rel_list_insert_prev() */
+
+static inline rel_link_t* rel_list_insert_next(rel_list_t* list, rel_link_t* link) {
+    return rel_link_insert_next(list, link);
+}   /* rel_list_insert_next() */
+
+static inline rel_link_t* rel_list_remove_prev(rel_list_t* list) {
+    return rel_list_empty(list) ? NULL : rel_link_remove(rel_link_prev(list));
+}   /* rel_list_remove_prev() */
+
+static inline rel_link_t* rel_list_remove_next(rel_list_t* list) {
+    return rel_list_empty(list) ? NULL : rel_link_remove(rel_link_next(list));
+}   /* rel_list_remove_next() */
+
+/**
+ * To use as a stack, assuming no duplicate links will be pushed:
+ */
+#define rel_list_push(_list,_link)  rel_list_insert_next((_list), (_link))
+#define rel_list_pop(_list)         rel_list_remove_next((_list))
+
+/**
+ * @return 1 if @a link is found within the first @a max_count items in @a
+ * list, starting with the list's next link.
+ */
+static inline int rel_list_has_link(rel_list_t* list, rel_link_t* link, int max_count) {
+    rel_link_t* list_link = rel_link_next(list);
+    while ((max_count-- > 0) && (list_link != list)) {
+        if (list_link == link) {
+            return 1;
+        }
+        list_link = rel_link_next(list_link);
+    }
+    return 0;
+}   /* rel_list_has_link() */
+
+/**
+ * For each link in @a _listp, run @a _code using variable name @a _linkp to
+ * hold the current link pointer.
+ *
+ * @a _linkp may be safely removed from @a _listp in @a _code.
+ */
+#define rel_list_foreach_link(_listp,_linkp,_code)                      \
+    do {                                                                \
+        rel_link_t* _linkp = rel_link_next(_listp);                     \
+        rel_link_t* __next = NULL;                                      \
+        for (; _linkp != (_listp); _linkp = __next) {                   \
+            __next = rel_link_next(_linkp);                             \
+            _code ;                                                     \
+        }                                                               \
+    } while (0)
+
+/**
+ * Using @a _listp as a list of structures of type @a _struct_type that are
+ * linked through rel_link_t field name @a _link_field_name, for each struct
+ * pointer @a _structp in the list, execute @a _code.
+ *
+ * @a _structp may be safely removed from @a _listp in @a _code.
+ */
+#define rel_list_foreach_struct(_listp,_structp,_struct_type,_link_field_name,_code) \
+    do {                                                                \
+        rel_link_t* __link = rel_link_next(_listp);                     \
+        rel_link_t* __next = NULL;                                      \
+        for (; __link != (_listp); __link = __next) {                   \
+            __next = rel_link_next(__link);                             \
+            _struct_type* _structp = STRUCT_CONTAINING_LINK(__link, _struct_type, _link_field_name); \
+            _code ;                                                     \
+        }                                                               \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MALLMOCK_REL_LIST_H_
@@ -0,0 +1,148 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Unit test program for rel_list.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cut.h"
+#include "rel_list.h"
+
+const char *g_program_name = "rel_list_test"; /**< This program name; overwritten by argv[0]. */
+
+#define TEST_ITEMS  16
+
+typedef struct item_s {
+    rel_link_t link;
+    int value;
+} item_t;
+
+/**
+ * Everything lives in one block, so that it can be moved as a whole.
+ */
+typedef struct image_s {
+    rel_list_t list;
+    item_t items[TEST_ITEMS];
+} image_t;
+
+typedef struct test_s {
+    image_t image;
+} test_t;
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_init(test_t *test) {
+    int i = 0;
+    rel_list_init(&test->image.list);
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        test->image.items[i].value = i;
+    }
+    CUT_TEST_PASS();
+}   /* test_init() */
+
+/* ------------------------------------------------------------------------- */
+static void test_exit(test_t *test) {
+}   /* test_exit() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_rel_list_basic(test_t *test) {
+    rel_list_t REL_LIST_INIT(list);
+    image_t *image = &test->image;
+    int expected = 0;
+
+    CUT_ASSERT_INT(8, sizeof(rel_link_t));
+    CUT_ASSERT(rel_list_empty(&list));
+    CUT_ASSERT(rel_list_empty(&image->list));
+    CUT_ASSERT_NULL(rel_list_pop(&image->list));
+    rel_list_insert_prev(&image->list, &image->items[1].link);
+    rel_list_insert_prev(&image->list, &image->items[2].link);
+    rel_list_insert_next(&image->list, &image->items[0].link);
+    CUT_ASSERT(!rel_list_empty(&image->list));
+    CUT_ASSERT(rel_list_has_link(&image->list, &image->items[2].link, 3));
+    CUT_ASSERT(!rel_list_has_link(&image->list, &image->items[2].link, 2));
+    rel_list_foreach_struct(&image->list, item, item_t, link,
+                            if (item->value != expected) { break; }
+                            expected++);
+    CUT_ASSERT_INT(3, expected);
+    CUT_ASSERT_POINTER(&image->items[2].link, rel_list_remove_prev(&image->list));
+    CUT_ASSERT_POINTER(&image->items[0].link, rel_list_pop(&image->list));
+    CUT_ASSERT_POINTER(&image->items[1].link, rel_list_pop(&image->list));
+    CUT_ASSERT_NULL(rel_list_pop(&image->list));
+    CUT_ASSERT(rel_list_empty(&image->list));
+    CUT_TEST_PASS();
+}   /* test_rel_list_basic() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_rel_list_relocate(test_t *test) {
+    image_t *copy = NULL;
+    int expected = 0;
+    int i = 0;
+
+    /* Link the items in reverse, so offsets go both ways. */
+    for (i = 0; i < TEST_ITEMS; ++i) {
+        rel_list_push(&test->image.list, &test->image.items[i].link);
+    }
+
+    CUT_ASSERT_NOT_NULL(copy = malloc(sizeof(*copy)));
+    memcpy(copy, &test->image, sizeof(*copy));
+    memset(&test->image, 0xA5, sizeof(test->image));
+
+    expected = TEST_ITEMS - 1;
+    rel_list_foreach_struct(&copy->list, item, item_t, link,
+                            if ((item != &copy->items[expected]) || (item->value != expected)) { break; }
+                            expected--);
+    CUT_ASSERT_INT(-1, expected);
+
+    rel_link_remove(&copy->items[5].link);
+    rel_list_insert_prev(&copy->list, &copy->items[5].link);
+    CUT_ASSERT_POINTER(&copy->items[5].link, rel_list_remove_prev(&copy->list));
+    CUT_ASSERT_POINTER(&copy->items[TEST_ITEMS - 1].link, rel_list_pop(&copy->list));
+    free(copy);
+    CUT_TEST_PASS();
+}   /* test_rel_list_relocate() */
+
+/* ------------------------------------------------------------------------- */
+void test_rel_list(void) {
+    CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
+    CUT_ADD_TEST(test_rel_list_basic);
+    CUT_ADD_TEST(test_rel_list_relocate);
+}   /* test_rel_list() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) CUT_GNU_ATTRIBUTE((noexit));
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [test-substring...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "\n");
+    cut_usage(f);
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    int i = 0;
+    g_program_name = argv[0];
+
+    cut_parse_command_line(&argc, argv);
+
+    CUT_INSTALL_SUITE(test_rel_list);
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else {
+            if (!cut_include_test(argv[i])) {
+                fprintf(stderr, "%s: no test names match '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+
+    return cut_run(1);
+}   /* main() */
@@ -4,25 +4,535 @@
 #ifndef LIB_SPIN_LOCK_H_
 #define LIB_SPIN_LOCK_H_
 
+/*
+ * Spin locks.
+ *
+ * Six variants. The four exclusive locks share the same shape of API - an
+ * init value, then *_try_acquire(), *_acquire() and *_release():
+ *
+ * - spin_lock_t, a test-and-test-and-set lock with exponential backoff. It
+ *   is the smallest and the cheapest when uncontended (a single CAS).
+ *
+ * - spin_ticket_lock_t, a fair (FIFO) ticket lock.
+ *
+ * - spin_mcs_lock_t, an MCS queue lock. Each waiter spins on its own
+ *   spin_mcs_node_t, so contention does not bounce a shared cache line. The
+ *   caller supplies the node, which must stay valid until release.
+ *
+ * - spin_adaptive_lock_t, which spins briefly and then sleeps in the kernel
+ *   (a futex on Linux). Use it when threads may outnumber CPUs, so that a
+ *   waiter does not burn its time slice while the holder is descheduled.
+ *
+ * The two for read-mostly data split that into a read side and a write
+ * side:
+ *
+ * - spin_rwlock_t, a reader-writer lock, with *_read_acquire() and
+ *   *_write_acquire() and their try and release calls. Readers share the
+ *   lock; a waiting writer holds off new readers so it cannot be starved.
+ *
+ * - spin_seqlock_t, a sequence lock, with *_read_begin() and
+ *   *_read_retry() around reads, and *_write_acquire() and
+ *   *_write_release() around writes. Readers never write to the lock, so
+ *   they do not contend with each other at all, but they must retry if a
+ *   writer got in while they were reading.
+ *
+ * Acquisition has acquire semantics and release has release semantics, as
+ * in the C11 memory model (using the GNU __atomic builtins so the header is
+ * usable from C++ as well).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(SPIN_LOCK_STATS)
+#include <stdio.h>
+#include <time.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#include <stdint.h>
+/**
+ * Initial and maximum number of pause instructions to wait after a failed
+ * attempt to take a contended spin_lock_t.
+ */
+#ifndef SPIN_LOCK_BACKOFF_MIN
+#define SPIN_LOCK_BACKOFF_MIN   (1)
+#endif
+#ifndef SPIN_LOCK_BACKOFF_MAX
+#define SPIN_LOCK_BACKOFF_MAX   (1024)
+#endif
+
+/**
+ * Number of pause instructions a spin_ticket_lock_t waiter waits for each
+ * ticket ahead of it before checking again.
+ */
+#ifndef SPIN_TICKET_LOCK_BACKOFF
+#define SPIN_TICKET_LOCK_BACKOFF (16)
+#endif
+
+/**
+ * Number of times a spin_adaptive_lock_t waiter checks the lock before
+ * going to sleep.
+ */
+#ifndef SPIN_ADAPTIVE_LOCK_SPINS
+#define SPIN_ADAPTIVE_LOCK_SPINS (100)
+#endif
+
+/**
+ * Tell the CPU that we're in a spin-wait loop.
+ */
+static inline void spin_lock_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}   /* spin_lock_pause() */
+
+/**
+ * Pause @p *backoff times, then double @p *backoff up to
+ * SPIN_LOCK_BACKOFF_MAX.
+ */
+static inline void spin_lock_backoff(uint32_t* backoff) {
+    uint32_t i;
+    for (i = 0; i < *backoff; ++i) {
+        spin_lock_pause();
+    }
+    if (*backoff < SPIN_LOCK_BACKOFF_MAX) {
+        *backoff <<= 1;
+    }
+}   /* spin_lock_backoff() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Test-and-test-and-set lock.
+ *
+ * When built with SPIN_LOCK_STATS defined (for example, `make
+ * SPIN_LOCK_STATS=1`), each spin_lock_t also records how often it was taken,
+ * how often it had to wait, how long it waited, and the longest time it was
+ * held. Print these with spin_lock_dump_stats().
+ */
+#if defined(SPIN_LOCK_STATS)
+
+/**
+ * Number of buckets in the spin histogram. Bucket 0 counts acquisitions that
+ * did not wait; bucket i > 0 counts those that waited [2^(i-1), 2^i) times
+ * around the spin loop, with the last bucket taking everything beyond.
+ */
+#define SPIN_LOCK_STATS_BUCKETS (16)
+
+typedef struct spin_lock_stats_s {
+    uint64_t acquisitions;  /**< Number of times the lock was taken. */
+    uint64_t contended;     /**< Number of those that found it already held. */
+    uint64_t spin_histogram[SPIN_LOCK_STATS_BUCKETS];   /**< See SPIN_LOCK_STATS_BUCKETS. */
+    uint64_t max_hold;      /**< Longest hold, in spin_lock_clock() units. */
+    uint64_t hold_start;    /**< spin_lock_clock() when last taken. */
+} spin_lock_stats_t;
+
+typedef struct spin_lock_s {
+    int32_t value;          /**< 0 when free, 1 when held. */
+    spin_lock_stats_t stats; /**< Written only by the holder. */
+} spin_lock_t;
+
+#define SPIN_LOCK_INIT_UNLOCKED { 0 }
+#define SPIN_LOCK_INIT_LOCKED   { 1 }
+
+#define SPIN_LOCK_VALUE(_sp)    (&(_sp)->value)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPIN_LOCK_CLOCK_UNITS   "ticks"
+#else
+#define SPIN_LOCK_CLOCK_UNITS   "ns"
+#endif
+
+/**
+ * @return a timestamp for measuring hold times; see SPIN_LOCK_CLOCK_UNITS.
+ */
+static inline uint64_t spin_lock_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}   /* spin_lock_clock() */
+
+/**
+ * Record an acquisition of @p sp, which is now held by the caller, that
+ * went around the spin loop @p spins times.
+ */
+static inline void spin_lock_stats_acquired(spin_lock_t* sp, uint32_t spins) {
+    int bucket = 0;
+    while ((spins > 0) && (bucket < SPIN_LOCK_STATS_BUCKETS - 1)) {
+        spins >>= 1;
+        ++bucket;
+    }
+    sp->stats.acquisitions++;
+    sp->stats.contended += (0 != bucket);
+    sp->stats.spin_histogram[bucket]++;
+    sp->stats.hold_start = spin_lock_clock();
+}   /* spin_lock_stats_acquired() */
+
+/**
+ * Record the release of @p sp, which is still held by the caller.
+ */
+static inline void spin_lock_stats_releasing(spin_lock_t* sp) {
+    uint64_t hold = spin_lock_clock() - sp->stats.hold_start;
+    if (hold > sp->stats.max_hold) {
+        sp->stats.max_hold = hold;
+    }
+}   /* spin_lock_stats_releasing() */
+
+/**
+ * Print the statistics for @p sp, labelled with @p name, to @p f. The lock
+ * should not be in use, or the numbers may be inconsistent.
+ */
+static inline void spin_lock_dump_stats(FILE* f, const char* name, const spin_lock_t* sp) {
+    const spin_lock_stats_t* stats = &sp->stats;
+    int i = 0;
+    fprintf(f, "%s: acquisitions=%llu contended=%llu (%.1f%%) max_hold=%llu %s\n",
+            name, (unsigned long long) stats->acquisitions, (unsigned long long) stats->contended,
+            (0 == stats->acquisitions) ? 0.0 : (100.0 * stats->contended / stats->acquisitions),
+            (unsigned long long) stats->max_hold, SPIN_LOCK_CLOCK_UNITS);
+    fprintf(f, "%s: spins", name);
+    for (i = 0; i < SPIN_LOCK_STATS_BUCKETS; ++i) {
+        if (0 != stats->spin_histogram[i]) {
+            if (0 == i) {
+                fprintf(f, " [0]=");
+            } else if (SPIN_LOCK_STATS_BUCKETS - 1 == i) {
+                fprintf(f, " [%u+]=", 1u << (i - 1));
+            } else {
+                fprintf(f, " [%u-%u]=", 1u << (i - 1), (1u << i) - 1);
+            }
+            fprintf(f, "%llu", (unsigned long long) stats->spin_histogram[i]);
+        }
+    }
+    fprintf(f, "\n");
+}   /* spin_lock_dump_stats() */
+
+#else
 
 typedef int32_t spin_lock_t;
 
 #define SPIN_LOCK_INIT_UNLOCKED (0)
 #define SPIN_LOCK_INIT_LOCKED   (1)
 
+#define SPIN_LOCK_VALUE(_sp)    (_sp)
+
+#define spin_lock_stats_acquired(_sp,_spins)    ((void) 0)
+#define spin_lock_stats_releasing(_sp)          ((void) 0)
+
+#endif  /* SPIN_LOCK_STATS */
+
+/**
+ * @return 1 if the lock was taken, 0 if it is held by someone else.
+ */
+static inline int spin_lock_try_acquire(spin_lock_t* sp) {
+    int32_t expected = 0;
+    if ((0 == __atomic_load_n(SPIN_LOCK_VALUE(sp), __ATOMIC_RELAXED)) &&
+        __atomic_compare_exchange_n(SPIN_LOCK_VALUE(sp), &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        spin_lock_stats_acquired(sp, 0);
+        return 1;
+    }
+    return 0;
+}   /* spin_lock_try_acquire() */
+
 static inline void spin_lock_acquire(spin_lock_t* sp) {
-    while (!__sync_bool_compare_and_swap(sp, 0, 1)) {
+    uint32_t backoff = SPIN_LOCK_BACKOFF_MIN;
+    uint32_t spins = 0;
+    for (;;) {
+        int32_t expected = 0;
+        if (__atomic_compare_exchange_n(SPIN_LOCK_VALUE(sp), &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            spin_lock_stats_acquired(sp, spins);
+            return;
+        }
+        /* Wait with plain reads so the cache line stays shared. */
+        do {
+            spin_lock_backoff(&backoff);
+            ++spins;
+        } while (0 != __atomic_load_n(SPIN_LOCK_VALUE(sp), __ATOMIC_RELAXED));
     }
-}
+}   /* spin_lock_acquire() */
 
 static inline void spin_lock_release(spin_lock_t* sp) {
-    *sp = 0;
-}
+    spin_lock_stats_releasing(sp);
+    __atomic_store_n(SPIN_LOCK_VALUE(sp), 0, __ATOMIC_RELEASE);
+}   /* spin_lock_release() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Ticket lock. Waiters are served in the order they arrived.
+ */
+typedef struct spin_ticket_lock_s {
+    uint32_t next;      /**< Next ticket to hand out. */
+    uint32_t serving;   /**< Ticket currently holding the lock. */
+} spin_ticket_lock_t;
+
+#define SPIN_TICKET_LOCK_INIT_UNLOCKED { 0, 0 }
+
+static inline int spin_ticket_lock_try_acquire(spin_ticket_lock_t* tp) {
+    uint32_t serving = __atomic_load_n(&tp->serving, __ATOMIC_RELAXED);
+    uint32_t expected = serving;
+    return __atomic_compare_exchange_n(&tp->next, &expected, serving + 1, 0,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}   /* spin_ticket_lock_try_acquire() */
+
+static inline void spin_ticket_lock_acquire(spin_ticket_lock_t* tp) {
+    uint32_t ticket = __atomic_fetch_add(&tp->next, 1, __ATOMIC_RELAXED);
+    uint32_t serving;
+    while (ticket != (serving = __atomic_load_n(&tp->serving, __ATOMIC_ACQUIRE))) {
+        /* Back off in proportion to our place in line. */
+        uint32_t i = (ticket - serving) * SPIN_TICKET_LOCK_BACKOFF;
+        while (i-- > 0) {
+            spin_lock_pause();
+        }
+    }
+}   /* spin_ticket_lock_acquire() */
+
+static inline void spin_ticket_lock_release(spin_ticket_lock_t* tp) {
+    /* Only the holder writes 'serving', so a plain read is fine. */
+    __atomic_store_n(&tp->serving, __atomic_load_n(&tp->serving, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}   /* spin_ticket_lock_release() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * MCS queue lock.
+ */
+typedef struct spin_mcs_node_s spin_mcs_node_t;
+
+struct spin_mcs_node_s {
+    spin_mcs_node_t* next;  /**< Waiter queued behind this one. */
+    int32_t locked;         /**< Non-zero while this waiter must wait. */
+};
+
+typedef struct spin_mcs_lock_s {
+    spin_mcs_node_t* tail;  /**< Last waiter in the queue, or NULL if free. */
+} spin_mcs_lock_t;
+
+#define SPIN_MCS_LOCK_INIT_UNLOCKED { NULL }
+
+static inline int spin_mcs_lock_try_acquire(spin_mcs_lock_t* mp, spin_mcs_node_t* node) {
+    spin_mcs_node_t* expected = NULL;
+    node->next = NULL;
+    node->locked = 0;
+    return __atomic_compare_exchange_n(&mp->tail, &expected, node, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}   /* spin_mcs_lock_try_acquire() */
+
+static inline void spin_mcs_lock_acquire(spin_mcs_lock_t* mp, spin_mcs_node_t* node) {
+    spin_mcs_node_t* prev = NULL;
+    node->next = NULL;
+    node->locked = 1;
+    prev = __atomic_exchange_n(&mp->tail, node, __ATOMIC_ACQ_REL);
+    if (NULL != prev) {
+        __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE)) {
+            spin_lock_pause();
+        }
+    }
+}   /* spin_mcs_lock_acquire() */
+
+static inline void spin_mcs_lock_release(spin_mcs_lock_t* mp, spin_mcs_node_t* node) {
+    spin_mcs_node_t* next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+    if (NULL == next) {
+        spin_mcs_node_t* expected = node;
+        if (__atomic_compare_exchange_n(&mp->tail, &expected, NULL, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+        /* Someone swapped in behind us but has not linked in yet. */
+        while (NULL == (next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE))) {
+            spin_lock_pause();
+        }
+    }
+    __atomic_store_n(&next->locked, 0, __ATOMIC_RELEASE);
+}   /* spin_mcs_lock_release() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Adaptive spin-then-sleep lock.
+ */
+typedef int32_t spin_adaptive_lock_t;
+
+#define SPIN_ADAPTIVE_LOCK_INIT_UNLOCKED (0)
+
+/* Values of a spin_adaptive_lock_t. */
+#define SPIN_ADAPTIVE_LOCK_FREE     (0)
+#define SPIN_ADAPTIVE_LOCK_HELD     (1)
+#define SPIN_ADAPTIVE_LOCK_WAITERS  (2)     /**< Held, and someone may sleep. */
+
+/**
+ * Sleep while @p *ap is still @p value.
+ */
+static inline void spin_adaptive_lock_wait(spin_adaptive_lock_t* ap, int32_t value) {
+#if defined(__linux__)
+    syscall(SYS_futex, ap, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+    (void) ap;
+    (void) value;
+    sched_yield();
+#endif
+}   /* spin_adaptive_lock_wait() */
+
+/**
+ * Wake one thread sleeping in spin_adaptive_lock_wait() on @p ap.
+ */
+static inline void spin_adaptive_lock_wake(spin_adaptive_lock_t* ap) {
+#if defined(__linux__)
+    syscall(SYS_futex, ap, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    (void) ap;
+#endif
+}   /* spin_adaptive_lock_wake() */
+
+static inline int spin_adaptive_lock_try_acquire(spin_adaptive_lock_t* ap) {
+    spin_adaptive_lock_t expected = SPIN_ADAPTIVE_LOCK_FREE;
+    return (SPIN_ADAPTIVE_LOCK_FREE == __atomic_load_n(ap, __ATOMIC_RELAXED)) &&
+        __atomic_compare_exchange_n(ap, &expected, SPIN_ADAPTIVE_LOCK_HELD, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}   /* spin_adaptive_lock_try_acquire() */
+
+static inline void spin_adaptive_lock_acquire(spin_adaptive_lock_t* ap) {
+    spin_adaptive_lock_t expected = SPIN_ADAPTIVE_LOCK_FREE;
+    int spins = 0;
+    if (__atomic_compare_exchange_n(ap, &expected, SPIN_ADAPTIVE_LOCK_HELD, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+    for (spins = 0; spins < SPIN_ADAPTIVE_LOCK_SPINS; ++spins) {
+        spin_lock_pause();
+        if (spin_adaptive_lock_try_acquire(ap)) {
+            return;
+        }
+    }
+    /*
+     * Mark the lock as having waiters. Whoever holds it will then wake us on
+     * release. If the exchange finds it free, we own it (still marked with
+     * waiters, which only costs a spurious wake later).
+     */
+    while (SPIN_ADAPTIVE_LOCK_FREE != __atomic_exchange_n(ap, SPIN_ADAPTIVE_LOCK_WAITERS, __ATOMIC_ACQUIRE)) {
+        spin_adaptive_lock_wait(ap, SPIN_ADAPTIVE_LOCK_WAITERS);
+    }
+}   /* spin_adaptive_lock_acquire() */
+
+static inline void spin_adaptive_lock_release(spin_adaptive_lock_t* ap) {
+    if (SPIN_ADAPTIVE_LOCK_WAITERS == __atomic_exchange_n(ap, SPIN_ADAPTIVE_LOCK_FREE, __ATOMIC_RELEASE)) {
+        spin_adaptive_lock_wake(ap);
+    }
+}   /* spin_adaptive_lock_release() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Reader-writer lock.
+ */
+typedef uint32_t spin_rwlock_t;
+
+#define SPIN_RWLOCK_INIT_UNLOCKED (0)
+
+#define SPIN_RWLOCK_WRITER      (1u)    /**< A writer holds the lock. */
+#define SPIN_RWLOCK_WRITER_WAIT (2u)    /**< A writer is waiting; readers stay out. */
+#define SPIN_RWLOCK_READER      (4u)    /**< Count of readers is in units of this. */
+
+static inline int spin_rwlock_try_read_acquire(spin_rwlock_t* rp) {
+    spin_rwlock_t state = __atomic_load_n(rp, __ATOMIC_RELAXED);
+    return (0 == (state & (SPIN_RWLOCK_WRITER | SPIN_RWLOCK_WRITER_WAIT))) &&
+        __atomic_compare_exchange_n(rp, &state, state + SPIN_RWLOCK_READER, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}   /* spin_rwlock_try_read_acquire() */
+
+static inline void spin_rwlock_read_acquire(spin_rwlock_t* rp) {
+    uint32_t backoff = SPIN_LOCK_BACKOFF_MIN;
+    while (!spin_rwlock_try_read_acquire(rp)) {
+        spin_lock_backoff(&backoff);
+    }
+}   /* spin_rwlock_read_acquire() */
+
+static inline void spin_rwlock_read_release(spin_rwlock_t* rp) {
+    __atomic_fetch_sub(rp, SPIN_RWLOCK_READER, __ATOMIC_RELEASE);
+}   /* spin_rwlock_read_release() */
+
+static inline int spin_rwlock_try_write_acquire(spin_rwlock_t* rp) {
+    spin_rwlock_t state = __atomic_load_n(rp, __ATOMIC_RELAXED);
+    /* Taking the lock clears any waiting flag; other waiters set it again. */
+    return (0 == (state & ~SPIN_RWLOCK_WRITER_WAIT)) &&
+        __atomic_compare_exchange_n(rp, &state, SPIN_RWLOCK_WRITER, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}   /* spin_rwlock_try_write_acquire() */
+
+static inline void spin_rwlock_write_acquire(spin_rwlock_t* rp) {
+    uint32_t backoff = SPIN_LOCK_BACKOFF_MIN;
+    while (!spin_rwlock_try_write_acquire(rp)) {
+        if (0 == (__atomic_load_n(rp, __ATOMIC_RELAXED) & SPIN_RWLOCK_WRITER_WAIT)) {
+            __atomic_fetch_or(rp, SPIN_RWLOCK_WRITER_WAIT, __ATOMIC_RELAXED);
+        }
+        spin_lock_backoff(&backoff);
+    }
+}   /* spin_rwlock_write_acquire() */
+
+static inline void spin_rwlock_write_release(spin_rwlock_t* rp) {
+    __atomic_fetch_and(rp, ~SPIN_RWLOCK_WRITER, __ATOMIC_RELEASE);
+}   /* spin_rwlock_write_release() */
+
+/* ------------------------------------------------------------------------- */
+/*
+ * Sequence lock. Writers serialize on an ordinary spin_lock_t and bump the
+ * sequence number before and after writing, so it is odd while a write is
+ * in progress. Intended usage for readers:
+ *
+ *    uint32_t seq;
+ *    do {
+ *        seq = spin_seqlock_read_begin(&lock);
+ *        copy = __atomic_load_n(&shared, __ATOMIC_RELAXED);
+ *    } while (spin_seqlock_read_retry(&lock, seq));
+ *
+ * The protected data should be read and written with (relaxed) atomic
+ * accesses, since readers may see a write in progress before retrying.
+ */
+typedef struct spin_seqlock_s {
+    uint32_t sequence;  /**< Odd while a writer is active. */
+    spin_lock_t lock;   /**< Serializes writers. */
+} spin_seqlock_t;
+
+#define SPIN_SEQLOCK_INIT_UNLOCKED { 0, SPIN_LOCK_INIT_UNLOCKED }
+
+/**
+ * @return the sequence number to pass to spin_seqlock_read_retry().
+ */
+static inline uint32_t spin_seqlock_read_begin(spin_seqlock_t* qp) {
+    uint32_t sequence;
+    while (0 != ((sequence = __atomic_load_n(&qp->sequence, __ATOMIC_ACQUIRE)) & 1)) {
+        spin_lock_pause();
+    }
+    return sequence;
+}   /* spin_seqlock_read_begin() */
+
+/**
+ * @return non-zero if a writer changed the data since
+ * spin_seqlock_read_begin() returned @p sequence, so it must be read again.
+ */
+static inline int spin_seqlock_read_retry(spin_seqlock_t* qp, uint32_t sequence) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return sequence != __atomic_load_n(&qp->sequence, __ATOMIC_RELAXED);
+}   /* spin_seqlock_read_retry() */
+
+static inline void spin_seqlock_write_acquire(spin_seqlock_t* qp) {
+    spin_lock_acquire(&qp->lock);
+    __atomic_store_n(&qp->sequence, qp->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}   /* spin_seqlock_write_acquire() */
+
+static inline void spin_seqlock_write_release(spin_seqlock_t* qp) {
+    __atomic_store_n(&qp->sequence, qp->sequence + 1, __ATOMIC_RELEASE);
+    spin_lock_release(&qp->lock);
+}   /* spin_seqlock_write_release() */
 
 #ifdef __cplusplus
 }
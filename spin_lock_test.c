@@ -0,0 +1,357 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Unit test program for spin_lock.h.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cut.h"
+#include "spin_lock.h"
+
+const char *g_program_name = "spin_lock_test"; /**< This program name; overwritten by argv[0]. */
+
+#define TEST_THREADS        4
+#define TEST_MAX_THREADS    64      /**< Most threads run by any test. */
+#define TEST_ITERATIONS     100000
+
+typedef struct test_s {
+    spin_lock_t lock;
+    spin_ticket_lock_t ticket_lock;
+    spin_mcs_lock_t mcs_lock;
+    spin_adaptive_lock_t adaptive_lock;
+    spin_rwlock_t rwlock;
+    spin_seqlock_t seqlock;
+    size_t counter;         /**< Protected by whichever lock is under test. */
+    size_t counter_copy;    /**< Always written along with counter. */
+    int torn_reads;         /**< Reads that saw counter != counter_copy. */
+} test_t;
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_init(test_t *test) {
+    spin_lock_t lock_init = SPIN_LOCK_INIT_UNLOCKED;
+    spin_ticket_lock_t ticket_init = SPIN_TICKET_LOCK_INIT_UNLOCKED;
+    spin_mcs_lock_t mcs_init = SPIN_MCS_LOCK_INIT_UNLOCKED;
+    spin_seqlock_t seqlock_init = SPIN_SEQLOCK_INIT_UNLOCKED;
+    test->lock = lock_init;
+    test->ticket_lock = ticket_init;
+    test->mcs_lock = mcs_init;
+    test->adaptive_lock = SPIN_ADAPTIVE_LOCK_INIT_UNLOCKED;
+    test->rwlock = SPIN_RWLOCK_INIT_UNLOCKED;
+    test->seqlock = seqlock_init;
+    CUT_TEST_PASS();
+}   /* test_init() */
+
+/* ------------------------------------------------------------------------- */
+static void test_exit(test_t *test) {
+}   /* test_exit() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * FIFO locks hand the lock to a waiter that may not be running, so with more
+ * threads than CPUs every handoff costs a time slice. Keep those tests to
+ * one thread per CPU.
+ *
+ * @return the number of threads to use for a fair lock test.
+ */
+static int fair_thread_count(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) {
+        return 1;
+    }
+    return (cpus < TEST_THREADS) ? (int) cpus : TEST_THREADS;
+}   /* fair_thread_count() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * A lock that sleeps rather than spins should keep working, and keep
+ * progressing, when some lock holders are not running.
+ *
+ * @return the number of threads to use for an oversubscribed lock test: one
+ * more than the CPU count, at least TEST_THREADS, and no more than
+ * TEST_MAX_THREADS.
+ */
+static int oversubscribed_thread_count(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < TEST_THREADS) {
+        return TEST_THREADS;
+    }
+    return (cpus < TEST_MAX_THREADS) ? (int) cpus + 1 : TEST_MAX_THREADS;
+}   /* oversubscribed_thread_count() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Run @p func on @p thread_count threads, each getting @p test.
+ *
+ * @return 1 on success, 0 if a thread could not be started.
+ */
+static int run_threads(void *(*func)(void *), test_t *test, int thread_count) {
+    pthread_t threads[TEST_MAX_THREADS];
+    int i = 0;
+    int ok = 1;
+    assert(thread_count <= TEST_MAX_THREADS);
+    for (i = 0; i < thread_count; ++i) {
+        if (0 != pthread_create(&threads[i], NULL, func, test)) {
+            ok = 0;
+            break;
+        }
+    }
+    while (i-- > 0) {
+        pthread_join(threads[i], NULL);
+    }
+    return ok;
+}   /* run_threads() */
+
+/* ------------------------------------------------------------------------- */
+static void *spin_lock_thread(void *arg) {
+    test_t *test = (test_t *) arg;
+    int i;
+    for (i = 0; i < TEST_ITERATIONS; ++i) {
+        spin_lock_acquire(&test->lock);
+        test->counter++;
+        spin_lock_release(&test->lock);
+    }
+    return NULL;
+}   /* spin_lock_thread() */
+
+/* ------------------------------------------------------------------------- */
+static void *spin_ticket_lock_thread(void *arg) {
+    test_t *test = (test_t *) arg;
+    int i;
+    for (i = 0; i < TEST_ITERATIONS; ++i) {
+        spin_ticket_lock_acquire(&test->ticket_lock);
+        test->counter++;
+        spin_ticket_lock_release(&test->ticket_lock);
+    }
+    return NULL;
+}   /* spin_ticket_lock_thread() */
+
+/* ------------------------------------------------------------------------- */
+static void *spin_mcs_lock_thread(void *arg) {
+    test_t *test = (test_t *) arg;
+    spin_mcs_node_t node;
+    int i;
+    for (i = 0; i < TEST_ITERATIONS; ++i) {
+        spin_mcs_lock_acquire(&test->mcs_lock, &node);
+        test->counter++;
+        spin_mcs_lock_release(&test->mcs_lock, &node);
+    }
+    return NULL;
+}   /* spin_mcs_lock_thread() */
+
+/* ------------------------------------------------------------------------- */
+static void *spin_adaptive_lock_thread(void *arg) {
+    test_t *test = (test_t *) arg;
+    int i;
+    for (i = 0; i < TEST_ITERATIONS; ++i) {
+        spin_adaptive_lock_acquire(&test->adaptive_lock);
+        test->counter++;
+        spin_adaptive_lock_release(&test->adaptive_lock);
+    }
+    return NULL;
+}   /* spin_adaptive_lock_thread() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Alternate between writing both counters and checking that they match.
+ */
+static void *spin_rwlock_thread(void *arg) {
+    test_t *test = (test_t *) arg;
+    int i;
+    for (i = 0; i < TEST_ITERATIONS; ++i) {
+        if (0 == (i & 3)) {
+            spin_rwlock_write_acquire(&test->rwlock);
+            test->counter++;
+            test->counter_copy++;
+            spin_rwlock_write_release(&test->rwlock);
+        } else {
+            spin_rwlock_read_acquire(&test->rwlock);
+            if (test->counter != test->counter_copy) {
+                __atomic_fetch_add(&test->torn_reads, 1, __ATOMIC_RELAXED);
+            }
+            spin_rwlock_read_release(&test->rwlock);
+        }
+    }
+    return NULL;
+}   /* spin_rwlock_thread() */
+
+/* ------------------------------------------------------------------------- */
+/**
+ * Alternate between writing both counters and checking that they match.
+ */
+static void *spin_seqlock_thread(void *arg) {
+    test_t *test = (test_t *) arg;
+    int i;
+    for (i = 0; i < TEST_ITERATIONS; ++i) {
+        if (0 == (i & 3)) {
+            spin_seqlock_write_acquire(&test->seqlock);
+            __atomic_store_n(&test->counter, test->counter + 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&test->counter_copy, test->counter_copy + 1, __ATOMIC_RELAXED);
+            spin_seqlock_write_release(&test->seqlock);
+        } else {
+            uint32_t sequence;
+            size_t counter;
+            size_t counter_copy;
+            do {
+                sequence = spin_seqlock_read_begin(&test->seqlock);
+                counter = __atomic_load_n(&test->counter, __ATOMIC_RELAXED);
+                counter_copy = __atomic_load_n(&test->counter_copy, __ATOMIC_RELAXED);
+            } while (spin_seqlock_read_retry(&test->seqlock, sequence));
+            if (counter != counter_copy) {
+                __atomic_fetch_add(&test->torn_reads, 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    return NULL;
+}   /* spin_seqlock_thread() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_spin_lock_try(test_t *test) {
+    spin_mcs_node_t node1;
+    spin_mcs_node_t node2;
+
+    CUT_ASSERT_INT(1, spin_lock_try_acquire(&test->lock));
+    CUT_ASSERT_INT(0, spin_lock_try_acquire(&test->lock));
+    spin_lock_release(&test->lock);
+    CUT_ASSERT_INT(1, spin_lock_try_acquire(&test->lock));
+    spin_lock_release(&test->lock);
+
+    CUT_ASSERT_INT(1, spin_ticket_lock_try_acquire(&test->ticket_lock));
+    CUT_ASSERT_INT(0, spin_ticket_lock_try_acquire(&test->ticket_lock));
+    spin_ticket_lock_release(&test->ticket_lock);
+    CUT_ASSERT_INT(1, spin_ticket_lock_try_acquire(&test->ticket_lock));
+    spin_ticket_lock_release(&test->ticket_lock);
+
+    CUT_ASSERT_INT(1, spin_mcs_lock_try_acquire(&test->mcs_lock, &node1));
+    CUT_ASSERT_INT(0, spin_mcs_lock_try_acquire(&test->mcs_lock, &node2));
+    spin_mcs_lock_release(&test->mcs_lock, &node1);
+    CUT_ASSERT_NULL(test->mcs_lock.tail);
+    CUT_ASSERT_INT(1, spin_mcs_lock_try_acquire(&test->mcs_lock, &node2));
+    spin_mcs_lock_release(&test->mcs_lock, &node2);
+
+    CUT_ASSERT_INT(1, spin_adaptive_lock_try_acquire(&test->adaptive_lock));
+    CUT_ASSERT_INT(0, spin_adaptive_lock_try_acquire(&test->adaptive_lock));
+    spin_adaptive_lock_release(&test->adaptive_lock);
+    CUT_ASSERT_INT(1, spin_adaptive_lock_try_acquire(&test->adaptive_lock));
+    spin_adaptive_lock_release(&test->adaptive_lock);
+
+    CUT_ASSERT_INT(1, spin_rwlock_try_read_acquire(&test->rwlock));
+    CUT_ASSERT_INT(1, spin_rwlock_try_read_acquire(&test->rwlock));
+    CUT_ASSERT_INT(0, spin_rwlock_try_write_acquire(&test->rwlock));
+    spin_rwlock_read_release(&test->rwlock);
+    spin_rwlock_read_release(&test->rwlock);
+    CUT_ASSERT_INT(1, spin_rwlock_try_write_acquire(&test->rwlock));
+    CUT_ASSERT_INT(0, spin_rwlock_try_read_acquire(&test->rwlock));
+    CUT_ASSERT_INT(0, spin_rwlock_try_write_acquire(&test->rwlock));
+    spin_rwlock_write_release(&test->rwlock);
+    CUT_ASSERT_INT(SPIN_RWLOCK_INIT_UNLOCKED, test->rwlock);
+    CUT_TEST_PASS();
+}   /* test_spin_lock_try() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_spin_lock_threads(test_t *test) {
+    int fair_threads = fair_thread_count();
+    int adaptive_threads = oversubscribed_thread_count();
+
+    CUT_ASSERT(run_threads(spin_lock_thread, test, TEST_THREADS));
+    CUT_ASSERT_INT(TEST_THREADS * TEST_ITERATIONS, test->counter);
+    CUT_ASSERT_INT(0, *SPIN_LOCK_VALUE(&test->lock));
+#if defined(SPIN_LOCK_STATS)
+    CUT_ASSERT_INT(TEST_THREADS * TEST_ITERATIONS, test->lock.stats.acquisitions);
+    CUT_ASSERT(test->lock.stats.contended <= test->lock.stats.acquisitions);
+    if (cut_print_case_flags & CUT_FLAG_PASS) {
+        spin_lock_dump_stats(stdout, "test->lock", &test->lock);
+    }
+#endif
+
+    test->counter = 0;
+    CUT_ASSERT(run_threads(spin_ticket_lock_thread, test, fair_threads));
+    CUT_ASSERT_INT(fair_threads * TEST_ITERATIONS, test->counter);
+    CUT_ASSERT_INT(test->ticket_lock.next, test->ticket_lock.serving);
+
+    test->counter = 0;
+    CUT_ASSERT(run_threads(spin_mcs_lock_thread, test, fair_threads));
+    CUT_ASSERT_INT(fair_threads * TEST_ITERATIONS, test->counter);
+    CUT_ASSERT_NULL(test->mcs_lock.tail);
+
+    /* The adaptive lock sleeps rather than spins, so oversubscribe it. */
+    test->counter = 0;
+    CUT_ASSERT(run_threads(spin_adaptive_lock_thread, test, adaptive_threads));
+    CUT_ASSERT_INT(adaptive_threads * TEST_ITERATIONS, test->counter);
+    CUT_ASSERT_INT(SPIN_ADAPTIVE_LOCK_FREE, test->adaptive_lock);
+    CUT_TEST_PASS();
+}   /* test_spin_lock_threads() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_spin_lock_read_mostly(test_t *test) {
+    uint32_t sequence = 0;
+
+    sequence = spin_seqlock_read_begin(&test->seqlock);
+    CUT_ASSERT_INT(0, spin_seqlock_read_retry(&test->seqlock, sequence));
+    spin_seqlock_write_acquire(&test->seqlock);
+    spin_seqlock_write_release(&test->seqlock);
+    CUT_ASSERT_INT(1, spin_seqlock_read_retry(&test->seqlock, sequence));
+
+    CUT_ASSERT(run_threads(spin_rwlock_thread, test, TEST_THREADS));
+    CUT_ASSERT_INT(TEST_THREADS * TEST_ITERATIONS / 4, test->counter);
+    CUT_ASSERT_INT(0, test->torn_reads);
+    CUT_ASSERT_INT(SPIN_RWLOCK_INIT_UNLOCKED, test->rwlock);
+
+    test->counter = 0;
+    test->counter_copy = 0;
+    CUT_ASSERT(run_threads(spin_seqlock_thread, test, TEST_THREADS));
+    CUT_ASSERT_INT(TEST_THREADS * TEST_ITERATIONS / 4, test->counter);
+    CUT_ASSERT_INT(0, test->torn_reads);
+    CUT_ASSERT_INT(0, test->seqlock.sequence & 1);
+    CUT_TEST_PASS();
+}   /* test_spin_lock_read_mostly() */
+
+/* ------------------------------------------------------------------------- */
+void test_spin_lock(void) {
+    CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
+    CUT_ADD_TEST(test_spin_lock_try);
+    CUT_ADD_TEST(test_spin_lock_threads);
+    CUT_ADD_TEST(test_spin_lock_read_mostly);
+}   /* test_spin_lock() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) CUT_GNU_ATTRIBUTE((noexit));
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [test-substring...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "\n");
+    cut_usage(f);
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    int i = 0;
+    g_program_name = argv[0];
+
+    cut_parse_command_line(&argc, argv);
+
+    CUT_INSTALL_SUITE(test_spin_lock);
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else {
+            if (!cut_include_test(argv[i])) {
+                fprintf(stderr, "%s: no test names match '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+
+    return cut_run(1);
+}   /* main() */
@@ -0,0 +1,159 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+#ifndef MALLMOCK_UNROLLED_LIST_H_
+#define MALLMOCK_UNROLLED_LIST_H_
+
+/*
+ * Unrolled list: a list of blocks, each holding many fixed-size elements
+ * stored inline. Walking it reads memory sequentially within each block,
+ * rather than chasing a pointer (and likely taking a cache miss) per
+ * element as with list_t. To hold pointers, use an element size of
+ * sizeof(void*).
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "link_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Size in bytes of each block, header included.
+ */
+#ifndef ULIST_BLOCK_SIZE
+#define ULIST_BLOCK_SIZE (4096)
+#endif
+
+typedef struct ulist_block_s {
+    link_t link;        /**< Link in the ulist_t's list of blocks. */
+    size_t count;       /**< Number of elements used in this block. */
+    union {
+        void* p;
+        long long ll;
+        double d;
+    } data[0];          /**< Elements, aligned for any ordinary type. */
+} ulist_block_t;
+
+typedef struct ulist_s {
+    list_t blocks;          /**< List of ulist_block_t. */
+    size_t element_size;    /**< Size of each element in bytes. */
+    size_t block_capacity;  /**< Number of elements that fit in a block. */
+    size_t count;           /**< Total number of elements. */
+} ulist_t;
+
+/**
+ * Initialize @p ul as an empty list of elements of @p element_size bytes.
+ */
+static inline ulist_t* ulist_init(ulist_t* ul, size_t element_size) {
+    list_init(&ul->blocks);
+    ul->element_size = element_size;
+    ul->block_capacity = (ULIST_BLOCK_SIZE - sizeof(ulist_block_t)) / element_size;
+    if (0 == ul->block_capacity) {
+        ul->block_capacity = 1;
+    }
+    ul->count = 0;
+    return ul;
+}   /* ulist_init() */
+
+/**
+ * Free all blocks of @p ul, leaving it empty.
+ */
+static inline void ulist_clear(ulist_t* ul) {
+    list_foreach_struct(&ul->blocks, block, ulist_block_t, link,
+                        link_remove(&block->link);
+                        free(block));
+    ul->count = 0;
+}   /* ulist_clear() */
+
+static inline size_t ulist_count(ulist_t* ul) {
+    return ul->count;
+}   /* ulist_count() */
+
+static inline int ulist_empty(ulist_t* ul) {
+    return 0 == ul->count;
+}   /* ulist_empty() */
+
+/**
+ * @return a pointer to element @p i of @p block in @p ul.
+ */
+static inline void* ulist_block_element(ulist_t* ul, ulist_block_t* block, size_t i) {
+    return (char*) block->data + i * ul->element_size;
+}   /* ulist_block_element() */
+
+/**
+ * Append a copy of the element at @p element to @p ul; if @p element is
+ * NULL then the new element is zeroed.
+ *
+ * @return a pointer to the new element in @p ul, or NULL if out of memory.
+ */
+static inline void* ulist_append(ulist_t* ul, const void* element) {
+    ulist_block_t* block = NULL;
+    void* new_element = NULL;
+
+    if (!list_empty(&ul->blocks)) {
+        block = STRUCT_CONTAINING_LINK(ul->blocks.prev, ulist_block_t, link);
+    }
+    if ((NULL == block) || (block->count == ul->block_capacity)) {
+        block = (ulist_block_t*) malloc(sizeof(ulist_block_t) + ul->block_capacity * ul->element_size);
+        if (NULL == block) {
+            return NULL;
+        }
+        block->count = 0;
+        list_insert_prev(&ul->blocks, &block->link);
+    }
+    new_element = ulist_block_element(ul, block, block->count);
+    if (NULL == element) {
+        memset(new_element, 0, ul->element_size);
+    } else {
+        memcpy(new_element, element, ul->element_size);
+    }
+    block->count++;
+    ul->count++;
+    return new_element;
+}   /* ulist_append() */
+
+/**
+ * @return a pointer to the (0-based) @p n-th element of @p ul, or NULL if
+ * there is no such element. This visits one block per ULIST_BLOCK_SIZE
+ * bytes of elements.
+ */
+static inline void* ulist_get(ulist_t* ul, size_t n) {
+    if (n >= ul->count) {
+        return NULL;
+    }
+    list_foreach_struct(&ul->blocks, block, ulist_block_t, link,
+                        if (n < block->count) {
+                            return ulist_block_element(ul, block, n);
+                        }
+                        n -= block->count);
+    return NULL;
+}   /* ulist_get() */
+
+/**
+ * Using @a _ulp as an unrolled list of elements of type @a _elem_type (which
+ * must match the element size given to ulist_init()), for each element
+ * pointer @a _elemp in the list, execute @a _code.
+ *
+ * Elements must not be added in @a _code. `break` ends the loop.
+ */
+#define ulist_foreach(_ulp,_elemp,_elem_type,_code)                     \
+    do {                                                                \
+        link_t* __blink = (_ulp)->blocks.next;                          \
+        ulist_block_t* __block = NULL;                                  \
+        size_t __i = 0;                                                 \
+        for (; __blink != &(_ulp)->blocks;                              \
+             (++__i < __block->count) ? 0 : (__blink = __blink->next, __i = 0)) { \
+            __block = STRUCT_CONTAINING_LINK(__blink, ulist_block_t, link); \
+            _elem_type* _elemp = (_elem_type*) __block->data + __i;     \
+            _code ;                                                     \
+        }                                                               \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MALLMOCK_UNROLLED_LIST_H_
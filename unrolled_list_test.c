@@ -0,0 +1,158 @@
+/* Copyright (c) 2019 Doug Rogers under the Zero Clause BSD License. */
+/* You are free to do whatever you want with this software. See LICENSE.txt. */
+
+/*
+ * Unit test program for unrolled_list.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cut.h"
+#include "mallmock.h"
+#include "unrolled_list.h"
+
+const char *g_program_name = "unrolled_list_test"; /**< This program name; overwritten by argv[0]. */
+
+typedef struct element_s {
+    int value;
+    char name[12];
+} element_t;
+
+typedef struct test_s {
+    ulist_t ul;
+} test_t;
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_init(test_t *test) {
+    ulist_init(&test->ul, sizeof(element_t));
+    CUT_TEST_PASS();
+}   /* test_init() */
+
+/* ------------------------------------------------------------------------- */
+static void test_exit(test_t *test) {
+    mallmock_reset();
+    ulist_clear(&test->ul);
+}   /* test_exit() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_ulist_empty(test_t *test) {
+    int visited = 0;
+
+    CUT_ASSERT(ulist_empty(&test->ul));
+    CUT_ASSERT_INT(0, ulist_count(&test->ul));
+    CUT_ASSERT_NULL(ulist_get(&test->ul, 0));
+    ulist_foreach(&test->ul, element, element_t, visited += (NULL != element));
+    CUT_ASSERT_INT(0, visited);
+    CUT_TEST_PASS();
+}   /* test_ulist_empty() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_ulist_many(test_t *test) {
+    const int count = (int) (3 * test->ul.block_capacity + 5);
+    element_t e;
+    element_t *stored = NULL;
+    int expected = 0;
+    int i = 0;
+
+    memset(&e, 0, sizeof(e));
+    for (i = 0; i < count; ++i) {
+        e.value = i;
+        snprintf(e.name, sizeof(e.name), "e%d", i);
+        CUT_ASSERT_NOT_NULL(stored = ulist_append(&test->ul, &e));
+        CUT_ASSERT_INT(i, stored->value);
+    }
+    CUT_ASSERT_NOT_NULL(stored = ulist_append(&test->ul, NULL));
+    CUT_ASSERT_INT(0, stored->value);
+    stored->value = count;
+    CUT_ASSERT_INT(count + 1, ulist_count(&test->ul));
+
+    ulist_foreach(&test->ul, element, element_t,
+                  if (element->value != expected) { break; }
+                  expected++);
+    CUT_ASSERT_INT(count + 1, expected);
+
+    expected = 0;
+    ulist_foreach(&test->ul, element, element_t,
+                  if (element->value == 7) { break; }
+                  expected++);
+    CUT_ASSERT_INT(7, expected);
+
+    CUT_ASSERT_NOT_NULL(stored = ulist_get(&test->ul, test->ul.block_capacity + 1));
+    CUT_ASSERT_INT(test->ul.block_capacity + 1, stored->value);
+    CUT_ASSERT_NOT_NULL(stored = ulist_get(&test->ul, count - 1));
+    CUT_ASSERT_STRING("e0", ((element_t *) ulist_get(&test->ul, 0))->name);
+    CUT_ASSERT_NULL(ulist_get(&test->ul, count + 1));
+
+    ulist_clear(&test->ul);
+    CUT_ASSERT(ulist_empty(&test->ul));
+    CUT_ASSERT(list_empty(&test->ul.blocks));
+    CUT_TEST_PASS();
+}   /* test_ulist_many() */
+
+/* ------------------------------------------------------------------------- */
+static cut_result_t test_ulist_low_memory(test_t *test) {
+    size_t i = 0;
+
+    /* The first append needs a block. */
+    mallmock_set_any_alloc_return(NULL, 0);
+    CUT_ASSERT_NULL(ulist_append(&test->ul, NULL));
+    CUT_ASSERT_INT(0, ulist_count(&test->ul));
+
+    /* Filling the first block takes one allocation; the next one fails. */
+    mallmock_set_any_alloc_return(NULL, 1);
+    for (i = 0; i < test->ul.block_capacity; ++i) {
+        CUT_ASSERT_NOT_NULL(ulist_append(&test->ul, NULL));
+    }
+    CUT_ASSERT_NULL(ulist_append(&test->ul, NULL));
+    CUT_ASSERT_INT(test->ul.block_capacity, ulist_count(&test->ul));
+    mallmock_reset();
+    CUT_ASSERT_NOT_NULL(ulist_append(&test->ul, NULL));
+    CUT_ASSERT_INT(test->ul.block_capacity + 1, ulist_count(&test->ul));
+    CUT_TEST_PASS();
+}   /* test_ulist_low_memory() */
+
+/* ------------------------------------------------------------------------- */
+void test_unrolled_list(void) {
+    CUT_CONFIG_SUITE(sizeof(test_t), test_init, test_exit);
+    CUT_ADD_TEST(test_ulist_empty);
+    CUT_ADD_TEST(test_ulist_many);
+    CUT_ADD_TEST(test_ulist_low_memory);
+}   /* test_unrolled_list() */
+
+/* ------------------------------------------------------------------------- */
+static void usage(FILE* f, int exit_code) CUT_GNU_ATTRIBUTE((noexit));
+static void usage(FILE* f, int exit_code) {
+    fprintf(f, "\n");
+    fprintf(f, "Usage: %s [options] [test-substring...]\n", g_program_name);
+    fprintf(f, "\n");
+    fprintf(f, "  -h, -help                     Print this usage information.\n");
+    fprintf(f, "\n");
+    cut_usage(f);
+    exit(exit_code);
+}   /* usage() */
+
+/* ------------------------------------------------------------------------- */
+int main(int argc, char* argv[]) {
+    int i = 0;
+    g_program_name = argv[0];
+
+    cut_parse_command_line(&argc, argv);
+
+    CUT_INSTALL_SUITE(test_unrolled_list);
+
+    for (i = 1; i < argc; ++i) {
+        if ((0 == strcmp(argv[i], "-h")) || (0 == strcmp(argv[i], "-help"))) {
+            usage(stdout, 0);
+        } else {
+            if (!cut_include_test(argv[i])) {
+                fprintf(stderr, "%s: no test names match '%s'\n", g_program_name, argv[i]);
+                fprintf(stderr, "%s: use -h for usage information\n", g_program_name);
+                exit(1);
+            }
+        }
+    }
+
+    return cut_run(1);
+}   /* main() */